@@ -0,0 +1,66 @@
+#ifndef CHUNKED_ARENA_HPP
+#define CHUNKED_ARENA_HPP
+
+#include <memory>
+#include <vector>
+
+namespace da_lab2 {
+
+    // Array of fixed-size chunks: growing never moves existing elements or needs a transient
+    // second copy, and shrinking hands whole chunks back to the allocator.
+    template <class T>
+    class ChunkedArena {
+    public:
+        static constexpr size_t CHUNK_BITS = 12;
+        static constexpr size_t CHUNK_SIZE = size_t{1} << CHUNK_BITS;
+
+        ChunkedArena() = default;
+
+        explicit ChunkedArena(size_t size) {
+            resize(size);
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        size_t capacity() const {
+            return chunks.size() * CHUNK_SIZE;
+        }
+
+        T& operator[](size_t i) {
+            return chunks[i >> CHUNK_BITS][i & (CHUNK_SIZE - 1)];
+        }
+
+        T const& operator[](size_t i) const {
+            return chunks[i >> CHUNK_BITS][i & (CHUNK_SIZE - 1)];
+        }
+
+        void push_back(T&& value) {
+            if (count == capacity()) {
+                chunks.push_back(std::make_unique<T[]>(CHUNK_SIZE));
+            }
+            (*this)[count++] = std::move(value);
+        }
+
+        void resize(size_t size) {
+            for (size_t i = size; i < count; ++i) {
+                (*this)[i] = T{};
+            }
+            chunks.resize((size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+            for (auto& chunk : chunks) {
+                if (!chunk) {
+                    chunk = std::make_unique<T[]>(CHUNK_SIZE);
+                }
+            }
+            count = size;
+        }
+
+    protected:
+        std::vector<std::unique_ptr<T[]>> chunks;
+        size_t count = 0;
+    };
+
+}
+
+#endif
@@ -0,0 +1,256 @@
+#ifndef COMMAND_HPP
+#define COMMAND_HPP
+
+#include <fast_io.hpp>
+#include <stats.hpp>
+#include <var.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+namespace da_lab2 {
+
+    enum class CommandType : uint8_t {
+        ADD,
+        REMOVE,
+        FIND,
+        SAVE,
+        LOAD,
+        PRINT,
+        RANGE,
+        PREFIX,
+        COMPACT,
+        STATS,
+        COUNT
+    };
+
+    inline constexpr char const* COMMAND_NAMES[] = {
+        "+", "-", "lookup", "Save", "Load", "print", "range", "prefix", "Compact", "stats"
+    };
+
+    static_assert(std::size(COMMAND_NAMES) == static_cast<size_t>(CommandType::COUNT));
+    static_assert(static_cast<size_t>(CommandType::COUNT) <= Stats::KINDS);
+
+    struct Command {
+        static constexpr uint64_t NO_LIMIT = UINT64_MAX;
+
+        CommandType type;
+        std::string word;
+        uint64_t value = 0;
+        // Upper bound of `range` and result limit of `range`/`prefix`.
+        std::string bound;
+        uint64_t limit = NO_LIMIT;
+    };
+
+    struct Response {
+        enum Kind : uint8_t {
+            OK,
+            EXIST,
+            NO_SUCH_WORD,
+            FOUND
+        };
+
+        Kind kind;
+        uint64_t value = 0;
+    };
+
+    // Optional trailing number on the rest of a line.
+    inline uint64_t parseLimit(std::string_view rest) {
+        uint64_t limit = 0;
+        bool any = false;
+        for (char c : rest) {
+            if ('0' <= c && c <= '9') {
+                limit = limit * 10 + static_cast<uint64_t>(c - '0');
+                any = true;
+            } else if (any) {
+                break;
+            }
+        }
+        return any ? limit : Command::NO_LIMIT;
+    }
+
+    // Cuts the next blank-separated field off `rest`, lowered.
+    inline void takeLoweredWord(std::string_view& rest, std::string& word) {
+        size_t start = std::min(rest.find_first_not_of(" \t\r"), rest.size());
+        size_t stop = std::min(rest.find_first_of(" \t\r", start), rest.size());
+        word = rest.substr(start, stop - start);
+        lower(word);
+        rest.remove_prefix(stop);
+    }
+
+    // Parses one command; `word` holds the lowered key, or the file name for Save/Load. Commands
+    // beyond the baseline ones are spelled `! Name ...` with operands on the same line, so no
+    // word that used to be a lookup changes meaning.
+    inline bool readCommand(BufferedReader& in, Command& c) {
+        std::string_view token;
+        if (!in.next(token)) {
+            return false;
+        }
+        c.value = 0;
+        if (token == "+") {
+            c.type = CommandType::ADD;
+            in.next(token);
+            c.word = token;
+            lower(c.word);
+            in.nextUnsigned(c.value);
+        } else if (token == "-") {
+            c.type = CommandType::REMOVE;
+            in.next(token);
+            c.word = token;
+            lower(c.word);
+        } else if (token == "!") {
+            in.next(token);
+            if (token == "Range" || token == "Prefix") {
+                c.type = token == "Range" ? CommandType::RANGE : CommandType::PREFIX;
+                auto rest = in.restOfLine();
+                takeLoweredWord(rest, c.word);
+                if (c.type == CommandType::RANGE) {
+                    takeLoweredWord(rest, c.bound);
+                }
+                c.limit = parseLimit(rest);
+                return true;
+            }
+            c.type = token == "Save" ? CommandType::SAVE
+                   : token == "Compact" ? CommandType::COMPACT
+                   : token == "Stats" ? CommandType::STATS
+                                      : CommandType::LOAD;
+            c.word = in.restOfLine();
+        } else if (token == "print") {
+            c.type = CommandType::PRINT;
+        } else {
+            c.type = CommandType::FIND;
+            c.word = token;
+            lower(c.word);
+        }
+        return true;
+    }
+
+    inline bool isKeyCommand(CommandType type) {
+        return type == CommandType::ADD || type == CommandType::REMOVE || type == CommandType::FIND;
+    }
+
+    // Applies a keyed command (+, -, lookup).
+    template <class Dictionary>
+    Response apply(Dictionary& dict, Command const& c) {
+        StatsTimer timer(static_cast<size_t>(c.type));
+        switch (c.type) {
+        case CommandType::ADD:
+            return {dict.add(var{Key(c.word), c.value}) ? Response::OK : Response::EXIST};
+        case CommandType::REMOVE:
+            return {dict.remove(c.word) ? Response::OK : Response::NO_SUCH_WORD};
+        default: {
+            Response r{Response::FOUND};
+            if (!dict.find(c.word, r.value)) {
+                r.kind = Response::NO_SUCH_WORD;
+            }
+            return r;
+        }
+        }
+    }
+
+    inline void writeResponse(BufferedWriter& out, Response const& r) {
+        switch (r.kind) {
+        case Response::OK:
+            out << "OK\n";
+            break;
+        case Response::EXIST:
+            out << "Exist\n";
+            break;
+        case Response::NO_SUCH_WORD:
+            out << "NoSuchWord\n";
+            break;
+        case Response::FOUND:
+            out << "OK: " << r.value << '\n';
+            break;
+        }
+    }
+
+    // Prints `word value` for every match in order, then OK. Only the matching part of the tree
+    // is visited: one seek, then successor steps until a word falls outside or the limit is hit.
+    template <class Dictionary>
+    void scan(Dictionary& dict, Command const& c, BufferedWriter& out) {
+        if constexpr (requires { dict.seek(std::string_view{}); }) {
+            uint64_t found = 0;
+            for (auto it = dict.seek(c.word); it.valid() && found < c.limit; it.next()) {
+                auto word = it.key();
+                if (c.type == CommandType::RANGE ? c.bound < word : !word.starts_with(c.word)) {
+                    break;
+                }
+                out << word << ' ' << it.value() << '\n';
+                ++found;
+            }
+            out << "OK\n";
+        } else {
+            out << "Unsupported\n";
+        }
+    }
+
+    // Tree shape is computed on demand; latency and allocation counters exist in LAB2_STATS builds.
+    template <class Dictionary>
+    void printStats(Dictionary& dict, BufferedWriter& out) {
+        std::ostringstream oss;
+        if constexpr (requires { dict.shape(); }) {
+            printShape(oss, dict.shape());
+        }
+        if constexpr (STATS_ENABLED) {
+            oss << "allocations: " << stats().allocations.load() << "\n"
+                << "heap bytes: " << stats().liveBytes.load() << "\n";
+            for (size_t kind = 0; kind < static_cast<size_t>(CommandType::COUNT); ++kind) {
+                printLatency(oss, COMMAND_NAMES[kind], stats().latency[kind]);
+            }
+        }
+        out << oss.view() << "OK\n";
+    }
+
+    template <class Dictionary>
+    void execute(Dictionary& dict, Command const& c, BufferedWriter& out) {
+        if (isKeyCommand(c.type)) {
+            writeResponse(out, apply(dict, c));
+            return;
+        }
+        StatsTimer timer(static_cast<size_t>(c.type));
+        switch (c.type) {
+        case CommandType::SAVE: {
+            std::ofstream off(c.word, std::ios_base::trunc);
+            dict.save(off);
+            off.close();
+            out << "OK\n";
+            break;
+        }
+        case CommandType::LOAD: {
+            std::ifstream iff(c.word);
+            dict.load(iff);
+            iff.close();
+            out << "OK\n";
+            break;
+        }
+        case CommandType::PRINT: {
+            std::ostringstream oss;
+            dict.print(oss);
+            out << oss.view() << '\n';
+            break;
+        }
+        case CommandType::RANGE:
+        case CommandType::PREFIX:
+            scan(dict, c, out);
+            break;
+        case CommandType::COMPACT:
+            if constexpr (requires { dict.compact(); }) {
+                dict.compact();
+            }
+            out << "OK\n";
+            break;
+        case CommandType::STATS:
+            printStats(dict, out);
+            break;
+        default:
+            break;
+        }
+    }
+
+}
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef COMPACT_DICTIONARY_HPP
+#define COMPACT_DICTIONARY_HPP
+
+#include <chunked_arena.hpp>
+#include <flat_rb_tree.hpp>
+#include <stats.hpp>
+#include <var.hpp>
+
+#include <cinttypes>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace da_lab2 {
+
+    // Append-only byte heap shared by all keys. A key is a varint length followed by its bytes
+    // and is addressed by a 32-bit offset.
+    class StringHeap {
+    public:
+        using offset = uint32_t;
+
+        offset append(std::string_view key) {
+            size_t start = bytes.size();
+            if (UINT32_MAX < start + key.size() + 5) {
+                throw std::length_error("Error: key heap exceeds 4 GiB");
+            }
+            auto length = key.size();
+            while (0x80 <= length) {
+                bytes.push_back(static_cast<char>(length | 0x80));
+                length >>= 7;
+            }
+            bytes.push_back(static_cast<char>(length));
+            bytes.insert(bytes.end(), key.begin(), key.end());
+            return static_cast<offset>(start);
+        }
+
+        std::string_view key(offset at) const {
+            size_t length = 0;
+            unsigned shift = 0;
+            auto c = static_cast<unsigned char>(bytes[at++]);
+            while (c & 0x80) {
+                length |= size_t{c & 0x7fu} << shift;
+                shift += 7;
+                c = static_cast<unsigned char>(bytes[at++]);
+            }
+            length |= size_t{c} << shift;
+            return {bytes.data() + at, length};
+        }
+
+        // Bytes `key(at)` occupies, header included.
+        size_t footprint(offset at) const {
+            auto k = key(at);
+            return static_cast<size_t>(k.data() - bytes.data()) + k.size() - at;
+        }
+
+        // Drops everything from `at` on; undoes the latest append.
+        void truncate(offset at) {
+            bytes.resize(at);
+        }
+
+        size_t size() const {
+            return bytes.size();
+        }
+
+        size_t capacity() const {
+            return bytes.capacity();
+        }
+
+    protected:
+        std::vector<char> bytes;
+    };
+
+    // 12 bytes with 4-byte alignment, so a tree node is 24 bytes.
+    struct CompactEntry {
+        StringHeap::offset key = 0;
+        uint32_t valueLow = 0;
+        uint32_t valueHigh = 0;
+
+        static CompactEntry make(StringHeap::offset key, uint64_t value) {
+            return {key, static_cast<uint32_t>(value), static_cast<uint32_t>(value >> 32)};
+        }
+
+        uint64_t value() const {
+            return (uint64_t{valueHigh} << 32) | valueLow;
+        }
+    };
+
+    struct CompactEntryLess {
+        using is_transparent = void;
+
+        StringHeap const* heap;
+
+        bool operator()(CompactEntry const& a, CompactEntry const& b) const {
+            return heap->key(a.key) < heap->key(b.key);
+        }
+
+        bool operator()(CompactEntry const& a, std::string_view b) const {
+            return heap->key(a.key) < b;
+        }
+
+        bool operator()(std::string_view a, CompactEntry const& b) const {
+            return a < heap->key(b.key);
+        }
+    };
+
+    // Memory-compact backend: 24-byte nodes in a chunked arena, linked by 32-bit indices with the
+    // colour packed into the parent index, and keys in one shared StringHeap. Removed nodes go to
+    // the free list and their key bytes become garbage; once either is more than half of its
+    // storage, `compact()` rewrites the heap and rebuilds the tree densely.
+    class CompactDictionary {
+    public:
+        using Tree = FlatRBTree<CompactEntry, CompactEntryLess, ChunkedArena>;
+
+        class Cursor {
+        public:
+            Cursor(Tree::Cursor cursor, StringHeap const* heap) : cursor(cursor), heap(heap) {}
+
+            bool valid() const {
+                return cursor.valid();
+            }
+
+            std::string_view key() const {
+                return heap->key(cursor->key);
+            }
+
+            uint64_t value() const {
+                return cursor->value();
+            }
+
+            void next() {
+                cursor.next();
+            }
+
+        protected:
+            Tree::Cursor cursor;
+            StringHeap const* heap;
+        };
+
+        CompactDictionary() : tree(CompactEntryLess{&heap}) {}
+
+        // The tree's comparator points at `heap`.
+        CompactDictionary(CompactDictionary const&) = delete;
+        CompactDictionary& operator=(CompactDictionary const&) = delete;
+
+        bool add(var const& v) {
+            auto at = heap.append(v.first.view());
+            if (!tree.add(CompactEntry::make(at, v.second))) {
+                heap.truncate(at);
+                return false;
+            }
+            return true;
+        }
+
+        bool remove(std::string_view word) {
+            auto entry = tree.find(word);
+            if (entry == nullptr) {
+                return false;
+            }
+            garbage += heap.footprint(entry->key);
+            tree.remove(word);
+            if (heap.size() < 2 * garbage || tree.size() < tree.freeSlots()) {
+                compact();
+            }
+            return true;
+        }
+
+        bool find(std::string_view word, uint64_t& value) {
+            auto entry = tree.find(word);
+            if (entry == nullptr) {
+                return false;
+            }
+            value = entry->value();
+            return true;
+        }
+
+        Cursor seek(std::string_view from) const {
+            return Cursor(tree.lowerBound(from), &heap);
+        }
+
+        TreeShape shape() const {
+            auto shape = tree.shape();
+            shape.bytes += heap.capacity();
+            return shape;
+        }
+
+        void compact() {
+            StringHeap fresh;
+            std::vector<CompactEntry> entries;
+            entries.reserve(tree.size());
+            tree.forEach([this, &fresh, &entries](CompactEntry const& e) {
+                entries.push_back({fresh.append(heap.key(e.key)), e.valueLow, e.valueHigh});
+            });
+            heap = std::move(fresh);
+            garbage = 0;
+            tree.assign(std::move(entries));
+        }
+
+        void save(std::ostream& os) {
+            tree.forEach([this, &os](CompactEntry const& e) {
+                os << heap.key(e.key) << ' ' << e.value() << '\n';
+            });
+        }
+
+        void load(std::istream& is) {
+            heap = StringHeap();
+            garbage = 0;
+            std::vector<CompactEntry> entries;
+            var v;
+            while (is >> v) {
+                entries.push_back(CompactEntry::make(heap.append(v.first.view()), v.second));
+            }
+            tree.assign(std::move(entries));
+        }
+
+        void print(std::ostream& os) {
+            tree.printTree(os, [this](std::ostream& os, CompactEntry const& e) {
+                os << heap.key(e.key) << ' ' << e.value();
+            });
+        }
+
+    protected:
+        StringHeap heap;
+        size_t garbage = 0;
+        Tree tree;
+    };
+
+}
+
+#endif
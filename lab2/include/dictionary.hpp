@@ -0,0 +1,141 @@
+#ifndef DICTIONARY_HPP
+#define DICTIONARY_HPP
+
+#include <flat_rb_tree.hpp>
+#include <rb_tree.hpp>
+#include <var.hpp>
+
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+namespace da_lab2 {
+
+    // Adapts cust::RBTree, which reports misses by throwing, to the bool interface the drivers use.
+    // Its lookups take a whole var, so the probe key is built in place (inline for short words).
+    class RBTreeDictionary {
+    public:
+        bool add(var const& v) {
+            try {
+                tree.add(v);
+                return true;
+            } catch (...) {
+                return false;
+            }
+        }
+
+        bool remove(std::string_view word) {
+            try {
+                tree.remove(var{Key(word), 0});
+                return true;
+            } catch (...) {
+                return false;
+            }
+        }
+
+        bool find(std::string_view word, uint64_t& value) {
+            try {
+                value = tree.find(var{Key(word), 0})->second;
+                return true;
+            } catch (...) {
+                return false;
+            }
+        }
+
+        void save(std::ostream& os) {
+            tree.saveInStream(os);
+        }
+
+        void load(std::istream& is) {
+            tree = std::move(cust::RBTree<var>::readFromStream(is));
+        }
+
+        void print(std::ostream& os) {
+            tree.printTree(os);
+        }
+
+    protected:
+        cust::RBTree<var> tree;
+    };
+
+    class FlatDictionary {
+    public:
+        class Cursor {
+        public:
+            explicit Cursor(FlatRBTree<var, VarLess>::Cursor cursor) : cursor(cursor) {}
+
+            bool valid() const {
+                return cursor.valid();
+            }
+
+            std::string_view key() const {
+                return cursor->first.view();
+            }
+
+            uint64_t value() const {
+                return cursor->second;
+            }
+
+            void next() {
+                cursor.next();
+            }
+
+        protected:
+            FlatRBTree<var, VarLess>::Cursor cursor;
+        };
+
+        bool add(var const& v) {
+            return tree.add(v);
+        }
+
+        bool remove(std::string_view word) {
+            return tree.remove(word);
+        }
+
+        bool find(std::string_view word, uint64_t& value) {
+            auto v = tree.find(word);
+            if (v == nullptr) {
+                return false;
+            }
+            value = v->second;
+            return true;
+        }
+
+        // Node storage plus the out-of-line bytes of long keys.
+        TreeShape shape() const {
+            auto shape = tree.shape();
+            tree.forEach([&shape](var const& v) {
+                if (!v.first.isInline()) {
+                    shape.bytes += v.first.size();
+                }
+            });
+            return shape;
+        }
+
+        Cursor seek(std::string_view from) const {
+            return Cursor(tree.lowerBound(from));
+        }
+
+        size_t insertBatch(std::vector<var> batch) {
+            return tree.insertBatch(std::move(batch));
+        }
+
+        void save(std::ostream& os) {
+            tree.saveInStream(os);
+        }
+
+        void load(std::istream& is) {
+            tree = FlatRBTree<var, VarLess>::readFromStream(is);
+        }
+
+        void print(std::ostream& os) {
+            tree.printTree(os);
+        }
+
+    protected:
+        FlatRBTree<var, VarLess> tree;
+    };
+
+}
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef FAST_IO_HPP
+#define FAST_IO_HPP
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace da_lab2 {
+
+    // Lowers 8 ASCII bytes at once: a byte gets its 0x20 bit set iff it lies in 'A'..'Z'.
+    inline uint64_t lowerAsciiWord(uint64_t w) {
+        constexpr uint64_t ones = 0x0101010101010101ull;
+        constexpr uint64_t high = 0x8080808080808080ull;
+        uint64_t heptets = w & ~high;
+        uint64_t geA = heptets + ones * (0x80 - 'A');
+        uint64_t gtZ = heptets + ones * (0x7f - 'Z');
+        uint64_t upper = (geA ^ gtZ) & ~w & high;
+        return w | (upper >> 2);
+    }
+
+    inline void lowerAscii(char* s, size_t size) {
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, s + i, 8);
+            w = lowerAsciiWord(w);
+            std::memcpy(s + i, &w, 8);
+        }
+        for (; i < size; ++i) {
+            unsigned c = static_cast<unsigned char>(s[i]);
+            s[i] = static_cast<char>(c | (static_cast<unsigned>(c - 'A' < 26u) << 5));
+        }
+    }
+
+    inline void lowerAscii(std::string& s) {
+        lowerAscii(s.data(), s.size());
+    }
+
+    inline bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // Refills with read(2), which returns what a pipe or terminal has instead of waiting for a
+    // whole block like fread, so an interactive client gets its replies line by line.
+    class BufferedReader {
+    public:
+        static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+        explicit BufferedReader(std::FILE* file, size_t blockSize = BLOCK_SIZE)
+            : fd(fileno(file)), buffer(blockSize) {}
+
+        BufferedReader(BufferedReader const&) = delete;
+        BufferedReader& operator=(BufferedReader const&) = delete;
+
+        // Runs before the reader may block for more input, e.g. to flush the replies so far.
+        void setBeforeRefill(std::function<void()> hook) {
+            beforeRefill = std::move(hook);
+        }
+
+        // Whether more input is buffered or can be read at once, so reading on won't wait.
+        bool ready() {
+            while (pos < end && isSpace(buffer[pos])) {
+                ++pos;
+            }
+            pollfd input{fd, POLLIN, 0};
+            return pos < end || ::poll(&input, 1, 0) == 1;
+        }
+
+        // Next whitespace separated token; the view stays valid till the next read.
+        bool next(std::string_view& token) {
+            skipSpaces();
+            if (!ensure()) {
+                return false;
+            }
+            size_t start = pos;
+            while (true) {
+                while (pos < end && !isSpace(buffer[pos])) {
+                    ++pos;
+                }
+                if (pos < end || !refillKeeping(start)) {
+                    break;
+                }
+            }
+            token = std::string_view(buffer.data() + start, pos - start);
+            return true;
+        }
+
+        bool nextUnsigned(uint64_t& value) {
+            std::string_view token;
+            if (!next(token) || token.empty()) {
+                return false;
+            }
+            value = 0;
+            for (char c : token) {
+                auto digit = static_cast<unsigned>(c - '0');
+                if (9 < digit) {
+                    return false;
+                }
+                value = value * 10 + digit;
+            }
+            return true;
+        }
+
+        // Rest of the current line after a single separator, like `get()` + `getline()`.
+        std::string_view restOfLine() {
+            if (ensure() && buffer[pos] != '\n') {
+                ++pos;
+            }
+            if (!ensure()) {
+                return {};
+            }
+            size_t start = pos;
+            while (true) {
+                while (pos < end && buffer[pos] != '\n') {
+                    ++pos;
+                }
+                if (pos < end || !refillKeeping(start)) {
+                    break;
+                }
+            }
+            std::string_view line(buffer.data() + start, pos - start);
+            if (pos < end) {
+                ++pos;
+            }
+            return line;
+        }
+
+    protected:
+        void skipSpaces() {
+            while (ensure() && isSpace(buffer[pos])) {
+                ++pos;
+            }
+        }
+
+        bool ensure() {
+            return pos < end || refillKeeping(pos);
+        }
+
+        // Moves [start, end) to the buffer front, growing it if the tail fills it, then reads more.
+        bool refillKeeping(size_t& start) {
+            size_t kept = end - start;
+            if (kept == buffer.size()) {
+                buffer.resize(buffer.size() * 2);
+            }
+            std::memmove(buffer.data(), buffer.data() + start, kept);
+            pos -= start;
+            start = 0;
+            end = kept;
+            if (beforeRefill) {
+                beforeRefill();
+            }
+            ssize_t got;
+            do {
+                got = ::read(fd, buffer.data() + end, buffer.size() - end);
+            } while (got < 0 && errno == EINTR);
+            if (got <= 0) {
+                return false;
+            }
+            end += static_cast<size_t>(got);
+            return true;
+        }
+
+    protected:
+        int fd;
+        std::vector<char> buffer;
+        size_t pos = 0;
+        size_t end = 0;
+        std::function<void()> beforeRefill;
+    };
+
+    class BufferedWriter {
+    public:
+        static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+        explicit BufferedWriter(std::FILE* file, size_t blockSize = BLOCK_SIZE)
+            : file(file), buffer(blockSize) {}
+
+        BufferedWriter(BufferedWriter const&) = delete;
+        BufferedWriter& operator=(BufferedWriter const&) = delete;
+
+        ~BufferedWriter() {
+            flush();
+        }
+
+        // Runs before any buffered bytes leave the process, e.g. to make logged mutations durable
+        // before they are acknowledged.
+        void setBeforeFlush(std::function<void()> hook) {
+            beforeFlush = std::move(hook);
+        }
+
+        BufferedWriter& operator<<(std::string_view s) {
+            if (buffer.size() - size < s.size()) {
+                flush();
+                if (buffer.size() < s.size()) {
+                    std::fwrite(s.data(), 1, s.size(), file);
+                    return *this;
+                }
+            }
+            std::memcpy(buffer.data() + size, s.data(), s.size());
+            size += s.size();
+            return *this;
+        }
+
+        BufferedWriter& operator<<(char c) {
+            if (size == buffer.size()) {
+                flush();
+            }
+            buffer[size++] = c;
+            return *this;
+        }
+
+        BufferedWriter& operator<<(uint64_t value) {
+            char digits[20];
+            size_t n = 0;
+            do {
+                digits[sizeof(digits) - ++n] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+            return *this << std::string_view(digits + sizeof(digits) - n, n);
+        }
+
+        // Drops the buffered bytes unwritten.
+        void discard() {
+            size = 0;
+        }
+
+        void flush() {
+            if (beforeFlush) {
+                beforeFlush();
+            }
+            if (size != 0) {
+                std::fwrite(buffer.data(), 1, size, file);
+                size = 0;
+            }
+            std::fflush(file);
+        }
+
+    protected:
+        std::FILE* file;
+        std::vector<char> buffer;
+        size_t size = 0;
+        std::function<void()> beforeFlush;
+    };
+
+}
+
+#endif
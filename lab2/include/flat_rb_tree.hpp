@@ -0,0 +1,567 @@
+#ifndef FLAT_RB_TREE_HPP
+#define FLAT_RB_TREE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <stats.hpp>
+
+namespace da_lab2 {
+
+    // Red-black tree whose nodes live in one array-like Storage and refer to each other by 32-bit
+    // index. Slot 0 is the black NIL sentinel, removed slots are chained into a free list. The
+    // colour takes the top bit of the parent index, so a tree holds at most MAX_NODES nodes and
+    // growing past that throws std::length_error.
+    template <class T, class Compare = std::less<>, template <class...> class Storage = std::vector>
+    class FlatRBTree {
+    public:
+        using index = uint32_t;
+        static constexpr index NIL = 0;
+        static constexpr size_t MAX_NODES = (size_t{1} << 31) - 1;
+
+        // In-order position; stays valid until the tree is modified.
+        class Cursor {
+        public:
+            bool valid() const {
+                return i != NIL;
+            }
+
+            T const& operator*() const {
+                return tree->nodes[i].value;
+            }
+
+            T const* operator->() const {
+                return &tree->nodes[i].value;
+            }
+
+            void next() {
+                i = tree->successor(i);
+            }
+
+        protected:
+            friend FlatRBTree;
+
+            Cursor(FlatRBTree const* tree, index i) : tree(tree), i(i) {}
+
+            FlatRBTree const* tree;
+            index i;
+        };
+
+        explicit FlatRBTree(Compare comp = Compare())
+            : nodes(1), comp(std::move(comp)) {}
+
+        size_t size() const {
+            return count;
+        }
+
+        // Slots on the free list.
+        size_t freeSlots() const {
+            return nodes.size() - 1 - count;
+        }
+
+        bool add(T value) {
+            index parent = NIL;
+            index cur = root;
+            bool goLeft = false;
+            while (cur != NIL) {
+                parent = cur;
+                if (comp(value, nodes[cur].value)) {
+                    cur = nodes[cur].left;
+                    goLeft = true;
+                } else if (comp(nodes[cur].value, value)) {
+                    cur = nodes[cur].right;
+                    goLeft = false;
+                } else {
+                    return false;
+                }
+            }
+            index z = allocate(std::move(value));
+            setParent(z, parent);
+            if (parent == NIL) {
+                root = z;
+            } else if (goLeft) {
+                nodes[parent].left = z;
+            } else {
+                nodes[parent].right = z;
+            }
+            insertFixup(z);
+            ++count;
+            return true;
+        }
+
+        template <class K>
+        bool remove(K const& key) {
+            index z = findIndex(key);
+            if (z == NIL) {
+                return false;
+            }
+            erase(z);
+            return true;
+        }
+
+        template <class K>
+        T* find(K const& key) {
+            index i = findIndex(key);
+            return i == NIL ? nullptr : &nodes[i].value;
+        }
+
+        // Node count, longest root-to-leaf path and bytes held by the node array.
+        TreeShape shape() const {
+            TreeShape shape{count, 0, nodes.capacity() * sizeof(Node)};
+            std::vector<std::pair<index, size_t>> stack;
+            if (root != NIL) {
+                stack.emplace_back(root, 1);
+            }
+            while (!stack.empty()) {
+                auto [i, depth] = stack.back();
+                stack.pop_back();
+                shape.height = std::max(shape.height, depth);
+                for (index child : {nodes[i].left, nodes[i].right}) {
+                    if (child != NIL) {
+                        stack.emplace_back(child, depth + 1);
+                    }
+                }
+            }
+            return shape;
+        }
+
+        // First element not less than `key`.
+        template <class K>
+        Cursor lowerBound(K const& key) const {
+            index cur = root;
+            index found = NIL;
+            while (cur != NIL) {
+                if (comp(nodes[cur].value, key)) {
+                    cur = nodes[cur].right;
+                } else {
+                    found = cur;
+                    cur = nodes[cur].left;
+                }
+            }
+            return Cursor(this, found);
+        }
+
+        void clear() {
+            nodes.resize(1);
+            root = NIL;
+            freeList = NIL;
+            count = 0;
+        }
+
+        template <class F>
+        void forEach(F&& f) const {
+            forEachIndex([this, &f](index i) {
+                f(nodes[i].value);
+            });
+        }
+
+        // Replaces the content with `batch`; duplicates keep their first occurrence.
+        void assign(std::vector<T> batch) {
+            sortUnique(batch);
+            build(batch);
+        }
+
+        // Inserts a batch, existing keys win. Small batches go through `add`, larger ones are
+        // merged with the in-order content and rebuilt in O(n + m).
+        size_t insertBatch(std::vector<T> batch) {
+            sortUnique(batch);
+            size_t before = count;
+            if (batch.size() * static_cast<size_t>(std::bit_width(count)) < count) {
+                for (auto& value : batch) {
+                    add(std::move(value));
+                }
+                return count - before;
+            }
+            std::vector<T> merged;
+            merged.reserve(count + batch.size());
+            std::vector<T> current = extract();
+            auto b = batch.begin();
+            for (auto& value : current) {
+                for (; b != batch.end() && comp(*b, value); ++b) {
+                    merged.push_back(std::move(*b));
+                }
+                if (b != batch.end() && !comp(value, *b)) {
+                    ++b;
+                }
+                merged.push_back(std::move(value));
+            }
+            std::move(b, batch.end(), std::back_inserter(merged));
+            build(merged);
+            return count - before;
+        }
+
+        void saveInStream(std::ostream& os) const {
+            forEach([&os](T const& value) {
+                os << value << '\n';
+            });
+        }
+
+        static FlatRBTree readFromStream(std::istream& is) {
+            std::vector<T> batch;
+            T value;
+            while (is >> value) {
+                batch.push_back(std::move(value));
+            }
+            FlatRBTree tree;
+            tree.assign(std::move(batch));
+            return tree;
+        }
+
+        void printTree(std::ostream& os) const {
+            printTree(os, [](std::ostream& os, T const& value) {
+                os << value;
+            });
+        }
+
+        // Prints sideways, right subtree first, one tab per level; `print(os, value)` renders a node.
+        template <class F>
+        void printTree(std::ostream& os, F&& print) const {
+            printSubtree(os, root, 0, print);
+        }
+
+    protected:
+        static constexpr index RED_BIT = index{1} << 31;
+
+        // The colour lives in the top bit of the parent index, which caps the tree at 2^31 nodes.
+        struct Node {
+            T value{};
+            index left = NIL;
+            index right = NIL;
+            index parentColor = NIL;
+        };
+
+        index parentOf(index i) const {
+            return nodes[i].parentColor & ~RED_BIT;
+        }
+
+        void setParent(index i, index parent) {
+            nodes[i].parentColor = (nodes[i].parentColor & RED_BIT) | parent;
+        }
+
+        bool isRed(index i) const {
+            return (nodes[i].parentColor & RED_BIT) != 0;
+        }
+
+        void setRed(index i, bool red) {
+            nodes[i].parentColor = (nodes[i].parentColor & ~RED_BIT) | (red ? RED_BIT : 0);
+        }
+
+        template <class K>
+        index findIndex(K const& key) const {
+            index cur = root;
+            while (cur != NIL) {
+                if (comp(key, nodes[cur].value)) {
+                    cur = nodes[cur].left;
+                } else if (comp(nodes[cur].value, key)) {
+                    cur = nodes[cur].right;
+                } else {
+                    return cur;
+                }
+            }
+            return NIL;
+        }
+
+        index successor(index i) const {
+            if (nodes[i].right != NIL) {
+                i = nodes[i].right;
+                while (nodes[i].left != NIL) {
+                    i = nodes[i].left;
+                }
+                return i;
+            }
+            index p = parentOf(i);
+            while (p != NIL && i == nodes[p].right) {
+                i = p;
+                p = parentOf(p);
+            }
+            return p;
+        }
+
+        index allocate(T&& value) {
+            index i;
+            if (freeList != NIL) {
+                i = freeList;
+                freeList = nodes[i].right;
+                nodes[i].value = std::move(value);
+            } else {
+                checkCapacity(nodes.size());
+                i = static_cast<index>(nodes.size());
+                nodes.push_back(Node{std::move(value)});
+            }
+            nodes[i].left = nodes[i].right = NIL;
+            setRed(i, true);
+            return i;
+        }
+
+        // Throws if `slots` nodes, besides NIL, would not fit the 31-bit indices.
+        static void checkCapacity(size_t slots) {
+            if (MAX_NODES < slots) {
+                throw std::length_error("Error: a flat red-black tree holds at most 2^31 - 1 nodes");
+            }
+        }
+
+        void release(index i) {
+            nodes[i].value = T{};
+            nodes[i].right = freeList;
+            freeList = i;
+        }
+
+        void sortUnique(std::vector<T>& batch) const {
+            auto less = [this](T const& a, T const& b) { return comp(a, b); };
+            if (!std::is_sorted(batch.begin(), batch.end(), less)) {
+                std::stable_sort(batch.begin(), batch.end(), less);
+            }
+            auto last = std::unique(batch.begin(), batch.end(), [this](T const& a, T const& b) {
+                return !comp(a, b) && !comp(b, a);
+            });
+            batch.erase(last, batch.end());
+        }
+
+        std::vector<T> extract() {
+            std::vector<T> values;
+            values.reserve(count);
+            forEachIndex([this, &values](index i) {
+                values.push_back(std::move(nodes[i].value));
+            });
+            return values;
+        }
+
+        template <class F>
+        void forEachIndex(F&& f) const {
+            std::vector<index> stack;
+            index cur = root;
+            while (cur != NIL || !stack.empty()) {
+                while (cur != NIL) {
+                    stack.push_back(cur);
+                    cur = nodes[cur].left;
+                }
+                cur = stack.back();
+                stack.pop_back();
+                f(cur);
+                cur = nodes[cur].right;
+            }
+        }
+
+        // Sorted unique input becomes a perfectly balanced tree; only the deepest, incomplete
+        // level is red, so every path keeps the same black height.
+        void build(std::vector<T>& sorted) {
+            checkCapacity(sorted.size());
+            clear();
+            nodes.resize(sorted.size() + 1);
+            count = sorted.size();
+            auto redDepth = static_cast<size_t>(std::bit_width(count + 1) - 1);
+            root = buildRange(sorted, 0, sorted.size(), NIL, 0, redDepth);
+        }
+
+        index buildRange(std::vector<T>& sorted, size_t lo, size_t hi, index parent, size_t depth, size_t redDepth) {
+            if (lo == hi) {
+                return NIL;
+            }
+            size_t mid = lo + (hi - lo) / 2;
+            auto i = static_cast<index>(mid + 1);
+            auto& node = nodes[i];
+            node.value = std::move(sorted[mid]);
+            node.parentColor = parent | (depth == redDepth ? RED_BIT : 0);
+            node.left = buildRange(sorted, lo, mid, i, depth + 1, redDepth);
+            node.right = buildRange(sorted, mid + 1, hi, i, depth + 1, redDepth);
+            return i;
+        }
+
+        void rotateLeft(index x) {
+            index y = nodes[x].right;
+            nodes[x].right = nodes[y].left;
+            if (nodes[y].left != NIL) {
+                setParent(nodes[y].left, x);
+            }
+            replaceChild(parentOf(x), x, y);
+            nodes[y].left = x;
+            setParent(x, y);
+        }
+
+        void rotateRight(index x) {
+            index y = nodes[x].left;
+            nodes[x].left = nodes[y].right;
+            if (nodes[y].right != NIL) {
+                setParent(nodes[y].right, x);
+            }
+            replaceChild(parentOf(x), x, y);
+            nodes[y].right = x;
+            setParent(x, y);
+        }
+
+        void replaceChild(index parent, index oldChild, index newChild) {
+            setParent(newChild, parent);
+            if (parent == NIL) {
+                root = newChild;
+            } else if (nodes[parent].left == oldChild) {
+                nodes[parent].left = newChild;
+            } else {
+                nodes[parent].right = newChild;
+            }
+        }
+
+        void insertFixup(index z) {
+            while (isRed(parentOf(z))) {
+                index p = parentOf(z);
+                index g = parentOf(p);
+                if (p == nodes[g].left) {
+                    index y = nodes[g].right;
+                    if (isRed(y)) {
+                        setRed(p, false);
+                        setRed(y, false);
+                        setRed(g, true);
+                        z = g;
+                    } else {
+                        if (z == nodes[p].right) {
+                            z = p;
+                            rotateLeft(z);
+                            p = parentOf(z);
+                        }
+                        setRed(p, false);
+                        setRed(g, true);
+                        rotateRight(g);
+                    }
+                } else {
+                    index y = nodes[g].left;
+                    if (isRed(y)) {
+                        setRed(p, false);
+                        setRed(y, false);
+                        setRed(g, true);
+                        z = g;
+                    } else {
+                        if (z == nodes[p].left) {
+                            z = p;
+                            rotateRight(z);
+                            p = parentOf(z);
+                        }
+                        setRed(p, false);
+                        setRed(g, true);
+                        rotateLeft(g);
+                    }
+                }
+            }
+            setRed(root, false);
+        }
+
+        void erase(index z) {
+            index y = z;
+            index x;
+            bool removedRed = isRed(y);
+            if (nodes[z].left == NIL) {
+                x = nodes[z].right;
+                replaceChild(parentOf(z), z, x);
+            } else if (nodes[z].right == NIL) {
+                x = nodes[z].left;
+                replaceChild(parentOf(z), z, x);
+            } else {
+                y = nodes[z].right;
+                while (nodes[y].left != NIL) {
+                    y = nodes[y].left;
+                }
+                removedRed = isRed(y);
+                x = nodes[y].right;
+                if (parentOf(y) == z) {
+                    setParent(x, y);
+                } else {
+                    replaceChild(parentOf(y), y, x);
+                    nodes[y].right = nodes[z].right;
+                    setParent(nodes[y].right, y);
+                }
+                replaceChild(parentOf(z), z, y);
+                nodes[y].left = nodes[z].left;
+                setParent(nodes[y].left, y);
+                setRed(y, isRed(z));
+            }
+            if (!removedRed) {
+                eraseFixup(x);
+            }
+            setParent(NIL, NIL);
+            release(z);
+            --count;
+        }
+
+        void eraseFixup(index x) {
+            while (x != root && !isRed(x)) {
+                index p = parentOf(x);
+                if (x == nodes[p].left) {
+                    index w = nodes[p].right;
+                    if (isRed(w)) {
+                        setRed(w, false);
+                        setRed(p, true);
+                        rotateLeft(p);
+                        w = nodes[p].right;
+                    }
+                    if (!isRed(nodes[w].left) && !isRed(nodes[w].right)) {
+                        setRed(w, true);
+                        x = p;
+                    } else {
+                        if (!isRed(nodes[w].right)) {
+                            setRed(nodes[w].left, false);
+                            setRed(w, true);
+                            rotateRight(w);
+                            w = nodes[p].right;
+                        }
+                        setRed(w, isRed(p));
+                        setRed(p, false);
+                        setRed(nodes[w].right, false);
+                        rotateLeft(p);
+                        x = root;
+                    }
+                } else {
+                    index w = nodes[p].left;
+                    if (isRed(w)) {
+                        setRed(w, false);
+                        setRed(p, true);
+                        rotateRight(p);
+                        w = nodes[p].left;
+                    }
+                    if (!isRed(nodes[w].right) && !isRed(nodes[w].left)) {
+                        setRed(w, true);
+                        x = p;
+                    } else {
+                        if (!isRed(nodes[w].left)) {
+                            setRed(nodes[w].right, false);
+                            setRed(w, true);
+                            rotateLeft(w);
+                            w = nodes[p].left;
+                        }
+                        setRed(w, isRed(p));
+                        setRed(p, false);
+                        setRed(nodes[w].left, false);
+                        rotateRight(p);
+                        x = root;
+                    }
+                }
+            }
+            setRed(x, false);
+        }
+
+        template <class F>
+        void printSubtree(std::ostream& os, index i, size_t depth, F& print) const {
+            if (i == NIL) {
+                return;
+            }
+            printSubtree(os, nodes[i].right, depth + 1, print);
+            os << std::string(depth, '\t');
+            print(os, nodes[i].value);
+            os << '\n';
+            printSubtree(os, nodes[i].left, depth + 1, print);
+        }
+
+    protected:
+        Storage<Node> nodes;
+        index root = NIL;
+        index freeList = NIL;
+        size_t count = 0;
+        Compare comp;
+    };
+
+}
+
+#endif
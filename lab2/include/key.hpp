@@ -0,0 +1,183 @@
+#ifndef KEY_HPP
+#define KEY_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <compare>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+namespace da_lab2 {
+
+    // 16-byte string key. Up to INLINE_SIZE bytes are stored in place; longer keys keep their first
+    // four bytes in place next to a pointer to an owned copy. The first four bytes, read as a
+    // big-endian number, decide most comparisons without touching the rest of the key.
+    class Key {
+    public:
+        static constexpr size_t INLINE_SIZE = 12;
+        static constexpr size_t PREFIX_SIZE = 4;
+
+        Key() = default;
+
+        explicit Key(std::string_view s) {
+            assign(s);
+        }
+
+        Key(Key const& other) {
+            assign(other.view());
+        }
+
+        Key(Key&& other) noexcept {
+            steal(other);
+        }
+
+        Key& operator=(Key const& other) {
+            if (this != &other) {
+                release();
+                assign(other.view());
+            }
+            return *this;
+        }
+
+        Key& operator=(Key&& other) noexcept {
+            if (this != &other) {
+                release();
+                steal(other);
+            }
+            return *this;
+        }
+
+        Key& operator=(std::string_view s) {
+            release();
+            assign(s);
+            return *this;
+        }
+
+        ~Key() {
+            release();
+        }
+
+        size_t size() const {
+            return length;
+        }
+
+        bool isInline() const {
+            return length <= INLINE_SIZE;
+        }
+
+        char const* data() const {
+            return isInline() ? head : heapBytes();
+        }
+
+        std::string_view view() const {
+            return {data(), length};
+        }
+
+        operator std::string_view() const {
+            return view();
+        }
+
+        uint32_t prefix() const {
+            return loadPrefix(head);
+        }
+
+        friend std::strong_ordering operator<=>(Key const& a, Key const& b) {
+            if (a.prefix() != b.prefix()) {
+                return a.prefix() <=> b.prefix();
+            }
+            return compareTail(a.view(), b.view());
+        }
+
+        friend std::strong_ordering operator<=>(Key const& a, std::string_view b) {
+            auto bPrefix = prefixOf(b);
+            if (a.prefix() != bPrefix) {
+                return a.prefix() <=> bPrefix;
+            }
+            return compareTail(a.view(), b);
+        }
+
+        friend bool operator==(Key const& a, Key const& b) {
+            return a.length == b.length && a.prefix() == b.prefix() && a.view() == b.view();
+        }
+
+        friend bool operator==(Key const& a, std::string_view b) {
+            return a.view() == b;
+        }
+
+        static uint32_t prefixOf(std::string_view s) {
+            char bytes[PREFIX_SIZE] = {};
+            if (!s.empty()) {
+                std::memcpy(bytes, s.data(), std::min(s.size(), PREFIX_SIZE));
+            }
+            return loadPrefix(bytes);
+        }
+
+    protected:
+        static uint32_t loadPrefix(char const* bytes) {
+            uint32_t p;
+            std::memcpy(&p, bytes, PREFIX_SIZE);
+            if constexpr (std::endian::native == std::endian::little) {
+                p = (p >> 24) | ((p >> 8) & 0xff00u) | ((p << 8) & 0xff0000u) | (p << 24);
+            }
+            return p;
+        }
+
+        static std::strong_ordering compareTail(std::string_view a, std::string_view b) {
+            int c = a.compare(b);
+            return c < 0 ? std::strong_ordering::less
+                 : c > 0 ? std::strong_ordering::greater
+                         : std::strong_ordering::equal;
+        }
+
+        char* heapBytes() const {
+            char* p;
+            std::memcpy(&p, head + PREFIX_SIZE, sizeof(p));
+            return p;
+        }
+
+        void assign(std::string_view s) {
+            length = static_cast<uint32_t>(s.size());
+            std::memset(head, 0, sizeof(head));
+            if (s.empty()) {
+                return;
+            }
+            if (isInline()) {
+                std::memcpy(head, s.data(), s.size());
+            } else {
+                char* p = new char[s.size()];
+                std::memcpy(p, s.data(), s.size());
+                std::memcpy(head, s.data(), PREFIX_SIZE);
+                std::memcpy(head + PREFIX_SIZE, &p, sizeof(p));
+            }
+        }
+
+        void steal(Key& other) {
+            length = other.length;
+            std::memcpy(head, other.head, sizeof(head));
+            other.length = 0;
+            std::memset(other.head, 0, sizeof(other.head));
+        }
+
+        void release() {
+            if (!isInline()) {
+                delete[] heapBytes();
+            }
+            length = 0;
+        }
+
+    protected:
+        uint32_t length = 0;
+        char head[INLINE_SIZE] = {};
+    };
+
+    static_assert(sizeof(Key) == 16);
+
+    inline std::ostream& operator<<(std::ostream& os, Key const& k) {
+        return os << k.view();
+    }
+
+}
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef PARALLEL_DRIVER_HPP
+#define PARALLEL_DRIVER_HPP
+
+#include <command.hpp>
+#include <fast_io.hpp>
+#include <sharded_dictionary.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace da_lab2 {
+
+    // Reads the log in batches and hands every key shard to one worker, so commands on the same
+    // key keep their order. Save, Load and print act as barriers between batches, and responses
+    // are buffered per batch and written in input order. Workers live as long as the driver and
+    // wait for the next batch on a condition variable; the calling thread is worker 0. A shard
+    // belongs to one worker within a batch and batches are separated by the condition variable
+    // handshake, so keyed commands go through ShardedDictionary::Owned without locks.
+    template <class Dictionary>
+    class ParallelDriver {
+    public:
+        static constexpr size_t BATCH_SIZE = 1 << 16;
+
+        ParallelDriver(ShardedDictionary<Dictionary>& dict, size_t threads)
+            : dict(dict), owned(dict), threads(threads == 0 ? 1 : threads),
+              batch(BATCH_SIZE), owners(BATCH_SIZE), responses(BATCH_SIZE) {
+            for (size_t w = 1; w < this->threads; ++w) {
+                workers.emplace_back([this, w] { workerLoop(w); });
+            }
+        }
+
+        ParallelDriver(ParallelDriver const&) = delete;
+        ParallelDriver& operator=(ParallelDriver const&) = delete;
+
+        ~ParallelDriver() {
+            {
+                std::lock_guard lock(mutex);
+                stopping = true;
+            }
+            started.notify_all();
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+
+        void run(BufferedReader& in, BufferedWriter& out) {
+            bool eof = false;
+            while (!eof) {
+                size_t size = 0;
+                bool barrier = false;
+                while (size < BATCH_SIZE) {
+                    if (!readCommand(in, batch[size])) {
+                        eof = true;
+                        break;
+                    }
+                    if (!isKeyCommand(batch[size].type)) {
+                        barrier = true;
+                        break;
+                    }
+                    owners[size] = dict.shardOf(batch[size].word) % threads;
+                    ++size;
+                    // An interactive client waits for these replies before it sends more.
+                    if (!in.ready()) {
+                        break;
+                    }
+                }
+                runBatch(size);
+                for (size_t i = 0; i < size; ++i) {
+                    writeResponse(out, responses[i]);
+                }
+                if (barrier) {
+                    execute(dict, batch[size], out);
+                }
+            }
+        }
+
+    protected:
+        void runBatch(size_t size) {
+            if (threads == 1) {
+                runWorker(0, size);
+                return;
+            }
+            {
+                std::lock_guard lock(mutex);
+                batchSize = size;
+                pending = threads - 1;
+                ++generation;
+            }
+            started.notify_all();
+            runWorker(0, size);
+            std::unique_lock lock(mutex);
+            finished.wait(lock, [this] { return pending == 0; });
+        }
+
+        void workerLoop(size_t worker) {
+            size_t seen = 0;
+            while (true) {
+                size_t size = 0;
+                {
+                    std::unique_lock lock(mutex);
+                    started.wait(lock, [this, seen] { return stopping || generation != seen; });
+                    if (stopping) {
+                        return;
+                    }
+                    seen = generation;
+                    size = batchSize;
+                }
+                runWorker(worker, size);
+                std::lock_guard lock(mutex);
+                if (--pending == 0) {
+                    finished.notify_one();
+                }
+            }
+        }
+
+        void runWorker(size_t worker, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                if (owners[i] == worker) {
+                    responses[i] = apply(owned, batch[i]);
+                }
+            }
+        }
+
+    protected:
+        ShardedDictionary<Dictionary>& dict;
+        typename ShardedDictionary<Dictionary>::Owned owned;
+        size_t threads;
+
+        std::vector<Command> batch;
+        std::vector<size_t> owners;
+        std::vector<Response> responses;
+
+        std::mutex mutex;
+        std::condition_variable started;
+        std::condition_variable finished;
+        size_t generation = 0;
+        size_t batchSize = 0;
+        size_t pending = 0;
+        bool stopping = false;
+        std::vector<std::thread> workers;
+    };
+
+}
+
+#endif
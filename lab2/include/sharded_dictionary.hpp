@@ -0,0 +1,211 @@
+#ifndef SHARDED_DICTIONARY_HPP
+#define SHARDED_DICTIONARY_HPP
+
+#include <stats.hpp>
+#include <var.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace da_lab2 {
+
+    inline uint64_t hashWord(std::string_view word) {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (char c : word) {
+            h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    // Walks several sorted cursors as one, always yielding the smallest current word.
+    template <class Cursor, class Lock>
+    class MergedCursor {
+    public:
+        MergedCursor(std::vector<Cursor> cursors, std::vector<Lock> locks)
+            : cursors(std::move(cursors)), locks(std::move(locks)) {
+            for (size_t i = 0; i < this->cursors.size(); ++i) {
+                if (this->cursors[i].valid()) {
+                    heap.push_back(i);
+                }
+            }
+            std::make_heap(heap.begin(), heap.end(), greater());
+        }
+
+        bool valid() const {
+            return !heap.empty();
+        }
+
+        std::string_view key() const {
+            return cursors[heap.front()].key();
+        }
+
+        uint64_t value() const {
+            return cursors[heap.front()].value();
+        }
+
+        void next() {
+            std::pop_heap(heap.begin(), heap.end(), greater());
+            auto& cursor = cursors[heap.back()];
+            cursor.next();
+            if (cursor.valid()) {
+                std::push_heap(heap.begin(), heap.end(), greater());
+            } else {
+                heap.pop_back();
+            }
+        }
+
+    protected:
+        auto greater() const {
+            return [this](size_t a, size_t b) {
+                return cursors[b].key() < cursors[a].key();
+            };
+        }
+
+        std::vector<Cursor> cursors;
+        std::vector<Lock> locks;
+        std::vector<size_t> heap;
+    };
+
+    // Splits the key space over independent dictionaries. Lookups of one shard run in parallel
+    // under a shared lock, writers of a shard are serialized, and different shards never contend.
+    // Callers that give every shard a single owning thread, as ParallelDriver does, go through
+    // Owned and take no lock at all.
+    template <class Dictionary>
+    class ShardedDictionary {
+    public:
+        static constexpr size_t DEFAULT_SHARD_COUNT = 64;
+
+        // Keyed commands without locks. Each shard must be used by one thread at a time, and a
+        // shard changes hands only across a synchronization point such as a joined batch; scans,
+        // Save, Load and print stay on the locked interface.
+        class Owned {
+        public:
+            explicit Owned(ShardedDictionary& sharded) : sharded(sharded) {}
+
+            bool add(var const& v) {
+                return sharded.shards[sharded.shardOf(v.first)].dict.add(v);
+            }
+
+            bool remove(std::string_view word) {
+                return sharded.shards[sharded.shardOf(word)].dict.remove(word);
+            }
+
+            bool find(std::string_view word, uint64_t& value) {
+                return sharded.shards[sharded.shardOf(word)].dict.find(word, value);
+            }
+
+        protected:
+            ShardedDictionary& sharded;
+        };
+
+        explicit ShardedDictionary(size_t shardCount = DEFAULT_SHARD_COUNT)
+            : shards(shardCount) {}
+
+        size_t shardCount() const {
+            return shards.size();
+        }
+
+        size_t shardOf(std::string_view word) const {
+            return hashWord(word) % shards.size();
+        }
+
+        bool add(var const& v) {
+            auto& shard = shards[shardOf(v.first)];
+            std::unique_lock lock(shard.mutex);
+            return shard.dict.add(v);
+        }
+
+        bool remove(std::string_view word) {
+            auto& shard = shards[shardOf(word)];
+            std::unique_lock lock(shard.mutex);
+            return shard.dict.remove(word);
+        }
+
+        bool find(std::string_view word, uint64_t& value) {
+            auto& shard = shards[shardOf(word)];
+            std::shared_lock lock(shard.mutex);
+            return shard.dict.find(word, value);
+        }
+
+        TreeShape shape() const
+            requires requires (Dictionary const& d) { d.shape(); } {
+            TreeShape total;
+            for (auto& shard : shards) {
+                std::shared_lock lock(shard.mutex);
+                auto shape = shard.dict.shape();
+                total.nodes += shape.nodes;
+                total.height = std::max(total.height, shape.height);
+                total.bytes += shape.bytes;
+            }
+            return total;
+        }
+
+        // Holds every shard's shared lock until the returned cursor is destroyed.
+        auto seek(std::string_view from) const
+            requires requires (Dictionary const& d) { d.seek(from); } {
+            using Cursor = decltype(std::declval<Dictionary const&>().seek(from));
+            using Lock = std::shared_lock<std::shared_mutex>;
+            std::vector<Cursor> cursors;
+            std::vector<Lock> locks;
+            for (auto& shard : shards) {
+                locks.emplace_back(shard.mutex);
+                cursors.push_back(shard.dict.seek(from));
+            }
+            return MergedCursor<Cursor, Lock>(std::move(cursors), std::move(locks));
+        }
+
+        // Plain `word value` records, the format of the unsharded dictionaries, so a file saved
+        // in one mode loads in the other whatever the shard count. Ordered when shards can seek.
+        void save(std::ostream& os) {
+            if constexpr (requires (Dictionary const& d) { d.seek(std::string_view{}); }) {
+                for (auto it = seek(std::string_view{}); it.valid(); it.next()) {
+                    os << it.key() << ' ' << it.value() << '\n';
+                }
+            } else {
+                for (auto& shard : shards) {
+                    std::shared_lock lock(shard.mutex);
+                    shard.dict.save(os);
+                }
+            }
+        }
+
+        // Routes every record to its shard by shardOf. A missing or empty file leaves the
+        // dictionary empty, as with the unsharded dictionaries.
+        void load(std::istream& is) {
+            std::vector<std::ostringstream> parts(shards.size());
+            var v;
+            while (is >> v) {
+                parts[shardOf(v.first.view())] << v << '\n';
+            }
+            for (size_t i = 0; i < shards.size(); ++i) {
+                std::istringstream iss(std::move(parts[i]).str());
+                std::unique_lock lock(shards[i].mutex);
+                shards[i].dict.load(iss);
+            }
+        }
+
+        void print(std::ostream& os) {
+            for (auto& shard : shards) {
+                std::shared_lock lock(shard.mutex);
+                shard.dict.print(os);
+            }
+        }
+
+    protected:
+        struct alignas(64) Shard {
+            mutable std::shared_mutex mutex;
+            Dictionary dict;
+        };
+
+        std::vector<Shard> shards;
+    };
+
+}
+
+#endif
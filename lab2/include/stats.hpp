@@ -0,0 +1,146 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cinttypes>
+#include <ostream>
+
+namespace da_lab2 {
+
+    struct TreeShape {
+        size_t nodes = 0;
+        size_t height = 0;
+        size_t bytes = 0;
+    };
+
+    // Log-linear histogram in the spirit of HdrHistogram: a value is bucketed by its highest set
+    // bit and the SUB_BITS bits below it, so every bucket is within 1/16 of the values it holds.
+    class LatencyHistogram {
+    public:
+        static constexpr unsigned SUB_BITS = 4;
+        static constexpr size_t SUB_COUNT = size_t{1} << SUB_BITS;
+        static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+        void record(uint64_t value) {
+            counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+            total.fetch_add(1, std::memory_order_relaxed);
+            uint64_t seen = maxValue.load(std::memory_order_relaxed);
+            while (seen < value && !maxValue.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+        }
+
+        uint64_t count() const {
+            return total.load(std::memory_order_relaxed);
+        }
+
+        uint64_t max() const {
+            return maxValue.load(std::memory_order_relaxed);
+        }
+
+        // Lower edge of the bucket holding the p-th quantile.
+        uint64_t percentile(double p) const {
+            auto n = count();
+            if (n == 0) {
+                return 0;
+            }
+            auto target = static_cast<uint64_t>(p * static_cast<double>(n - 1)) + 1;
+            uint64_t seen = 0;
+            for (size_t b = 0; b < BUCKETS; ++b) {
+                seen += counts[b].load(std::memory_order_relaxed);
+                if (target <= seen) {
+                    return bucketLow(b);
+                }
+            }
+            return max();
+        }
+
+        static size_t bucketOf(uint64_t value) {
+            if (value < SUB_COUNT) {
+                return value;
+            }
+            auto shift = static_cast<unsigned>(63 - std::countl_zero(value)) - SUB_BITS;
+            return (shift + 1) * SUB_COUNT + ((value >> shift) & (SUB_COUNT - 1));
+        }
+
+        static uint64_t bucketLow(size_t bucket) {
+            if (bucket < SUB_COUNT) {
+                return bucket;
+            }
+            auto shift = bucket / SUB_COUNT - 1;
+            return (SUB_COUNT + bucket % SUB_COUNT) << shift;
+        }
+
+    protected:
+        std::array<std::atomic<uint64_t>, BUCKETS> counts{};
+        std::atomic<uint64_t> total{0};
+        std::atomic<uint64_t> maxValue{0};
+    };
+
+#ifdef LAB2_STATS
+    constexpr bool STATS_ENABLED = true;
+#else
+    constexpr bool STATS_ENABLED = false;
+#endif
+
+    // Process-wide counters; the allocation ones are fed by src/allocation_counter.cpp.
+    struct Stats {
+        static constexpr size_t KINDS = 16;
+
+        std::array<LatencyHistogram, KINDS> latency;
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> liveBytes{0};
+    };
+
+    inline Stats& stats() {
+        static Stats instance;
+        return instance;
+    }
+
+    // Records the lifetime of a scope into the histogram of `kind`; empty unless LAB2_STATS is set.
+    template <bool Enabled = STATS_ENABLED>
+    class StatsTimer {
+    public:
+        explicit StatsTimer(size_t) {}
+    };
+
+    template <>
+    class StatsTimer<true> {
+    public:
+        explicit StatsTimer(size_t kind)
+            : kind(kind), start(std::chrono::steady_clock::now()) {}
+
+        StatsTimer(StatsTimer const&) = delete;
+        StatsTimer& operator=(StatsTimer const&) = delete;
+
+        ~StatsTimer() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            stats().latency[kind].record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()
+            ));
+        }
+
+    protected:
+        size_t kind;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    inline void printShape(std::ostream& os, TreeShape const& shape) {
+        os << "nodes: " << shape.nodes << "\n"
+           << "height: " << shape.height << "\n"
+           << "bytes: " << shape.bytes << "\n";
+    }
+
+    inline void printLatency(std::ostream& os, char const* name, LatencyHistogram const& h) {
+        os << name << ": count " << h.count()
+           << " p50 " << h.percentile(0.5) << "ns"
+           << " p90 " << h.percentile(0.9) << "ns"
+           << " p99 " << h.percentile(0.99) << "ns"
+           << " p999 " << h.percentile(0.999) << "ns"
+           << " max " << h.max() << "ns\n";
+    }
+
+}
+
+#endif
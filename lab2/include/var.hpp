@@ -0,0 +1,62 @@
+#ifndef VAR_HPP
+#define VAR_HPP
+
+#include <fast_io.hpp>
+#include <key.hpp>
+
+#include <cinttypes>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace da_lab2 {
+
+    struct var {
+        Key first;
+        uint64_t second;
+    };
+
+    inline bool operator==(var const& a, var const& b) {
+        return a.first == b.first;
+    }
+
+    inline bool operator<(var const& a, var const& b) {
+        return a.first < b.first;
+    }
+
+    // Lets trees look words up by std::string_view without building a probe var.
+    struct VarLess {
+        using is_transparent = void;
+
+        bool operator()(var const& a, var const& b) const {
+            return a.first < b.first;
+        }
+
+        bool operator()(var const& a, std::string_view b) const {
+            return a.first < b;
+        }
+
+        bool operator()(std::string_view a, var const& b) const {
+            return b.first > a;
+        }
+    };
+
+    inline void lower(std::string& s) {
+        lowerAscii(s);
+    }
+
+    inline std::istream& operator>>(std::istream& iss, var& v) {
+        std::string word;
+        iss >> word >> v.second;
+        lower(word);
+        v.first = word;
+        return iss;
+    }
+
+    inline std::ostream& operator<<(std::ostream& os, var const& v) {
+        return os << v.first << " " << v.second;
+    }
+
+}
+
+#endif
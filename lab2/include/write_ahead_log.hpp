@@ -0,0 +1,361 @@
+#ifndef WRITE_AHEAD_LOG_HPP
+#define WRITE_AHEAD_LOG_HPP
+
+#include <sharded_dictionary.hpp>
+#include <var.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace da_lab2 {
+
+    struct WalConfig {
+        std::string path;
+        // A batch is committed once it holds this many bytes or is this old, whichever comes first.
+        size_t batchBytes = 1 << 16;
+        std::chrono::milliseconds interval{10};
+        // The log is folded into the snapshot once it grows past this size.
+        size_t compactBytes = size_t{1} << 26;
+    };
+
+    // Append-only log of `+`/`-` records: type byte, key length, key, value (adds only) and a
+    // 32-bit checksum. Records are batched in memory and written with one write + fdatasync.
+    class WriteAheadLog {
+    public:
+        enum RecordType : uint8_t {
+            ADD = 1,
+            REMOVE = 2
+        };
+
+        explicit WriteAheadLog(WalConfig config)
+            : config(std::move(config)), lastCommit(clock::now()) {}
+
+        WriteAheadLog(WriteAheadLog const&) = delete;
+        WriteAheadLog& operator=(WriteAheadLog const&) = delete;
+
+        // A failed last commit can't be reported from here, so owners that need to know call
+        // close() themselves.
+        ~WriteAheadLog() {
+            try {
+                close();
+            } catch (std::exception const& e) {
+                std::cerr << e.what() << "\n";
+            }
+        }
+
+        // Commits what is pending and closes the log.
+        void close() {
+            if (fd == -1) {
+                return;
+            }
+            int file = fd;
+            fd = -1;
+            try {
+                commitTo(file);
+            } catch (...) {
+                ::close(file);
+                throw;
+            }
+            if (::close(file) != 0) {
+                throw std::runtime_error("Error: can't close write-ahead log");
+            }
+        }
+
+        std::string snapshotPath() const {
+            return config.path + ".snapshot";
+        }
+
+        // Applies every complete record to `apply(type, key, value)` and cuts off a torn tail.
+        template <class F>
+        void replay(F&& apply) {
+            std::vector<char> log = readAll(config.path);
+            size_t pos = 0;
+            while (true) {
+                size_t next = pos;
+                RecordType type;
+                std::string_view key;
+                uint64_t value = 0;
+                if (!decode(log, next, type, key, value)) {
+                    break;
+                }
+                apply(type, key, value);
+                pos = next;
+            }
+            open();
+            if (pos != log.size() && ::ftruncate(fd, static_cast<off_t>(pos)) != 0) {
+                throw std::runtime_error("Error: can't truncate write-ahead log");
+            }
+            logBytes = pos;
+        }
+
+        void append(RecordType type, std::string_view key, uint64_t value) {
+            size_t start = pending.size();
+            pending.push_back(static_cast<char>(type));
+            put(static_cast<uint32_t>(key.size()));
+            pending.insert(pending.end(), key.begin(), key.end());
+            if (type == ADD) {
+                put(value);
+            }
+            put(checksum(std::string_view(pending.data() + start, pending.size() - start)));
+        }
+
+        bool commitDue() const {
+            return config.batchBytes <= pending.size()
+                || (!pending.empty() && config.interval <= clock::now() - lastCommit);
+        }
+
+        bool compactionDue() const {
+            return config.compactBytes <= logBytes;
+        }
+
+        void commit() {
+            commitTo(fd);
+        }
+
+        // Atomically replaces the snapshot with `save(os)` output, then empties the log. The
+        // rename is made durable by syncing the directory before the log is truncated, or a
+        // crash could leave the old snapshot next to an empty log.
+        template <class F>
+        void compact(F&& save) {
+            std::string tmp = snapshotPath() + ".tmp";
+            {
+                std::ofstream off(tmp, std::ios_base::trunc);
+                save(off);
+                off.close();
+                if (!off) {
+                    throw std::runtime_error("Error: can't write snapshot " + tmp);
+                }
+            }
+            syncFile(tmp);
+            if (std::rename(tmp.c_str(), snapshotPath().c_str()) != 0) {
+                throw std::runtime_error("Error: can't replace snapshot " + snapshotPath());
+            }
+            syncFile(directoryOf(snapshotPath()));
+            pending.clear();
+            if (::ftruncate(fd, 0) != 0) {
+                throw std::runtime_error("Error: can't truncate write-ahead log");
+            }
+            if (::fdatasync(fd) != 0) {
+                throw std::runtime_error("Error: can't sync write-ahead log");
+            }
+            logBytes = 0;
+        }
+
+    protected:
+        using clock = std::chrono::steady_clock;
+
+        void open() {
+            fd = ::open(config.path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+            if (fd == -1) {
+                throw std::runtime_error("Error: can't open write-ahead log " + config.path);
+            }
+        }
+
+        void commitTo(int file) {
+            lastCommit = clock::now();
+            if (pending.empty()) {
+                return;
+            }
+            size_t written = 0;
+            while (written < pending.size()) {
+                auto n = ::write(file, pending.data() + written, pending.size() - written);
+                if (n < 0) {
+                    // Cut a partial batch off so a retry doesn't append after a torn record.
+                    if (written != 0 && ::ftruncate(file, static_cast<off_t>(logBytes)) != 0) {
+                        throw std::runtime_error("Error: can't truncate write-ahead log");
+                    }
+                    throw std::runtime_error("Error: can't write to write-ahead log");
+                }
+                written += static_cast<size_t>(n);
+            }
+            if (::fdatasync(file) != 0) {
+                throw std::runtime_error("Error: can't sync write-ahead log");
+            }
+            logBytes += pending.size();
+            pending.clear();
+        }
+
+        template <class T>
+        void put(T value) {
+            char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            pending.insert(pending.end(), bytes, bytes + sizeof(T));
+        }
+
+        template <class T>
+        static bool get(std::vector<char> const& log, size_t& pos, T& value) {
+            if (log.size() - pos < sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&value, log.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return true;
+        }
+
+        static bool decode(std::vector<char> const& log, size_t& pos, RecordType& type, std::string_view& key, uint64_t& value) {
+            size_t start = pos;
+            uint8_t rawType;
+            uint32_t length;
+            if (!get(log, pos, rawType) || !get(log, pos, length) || log.size() - pos < length) {
+                return false;
+            }
+            type = static_cast<RecordType>(rawType);
+            key = std::string_view(log.data() + pos, length);
+            pos += length;
+            if (type == ADD && !get(log, pos, value)) {
+                return false;
+            }
+            auto expected = checksum(std::string_view(log.data() + start, pos - start));
+            uint32_t stored;
+            return (type == ADD || type == REMOVE) && get(log, pos, stored) && stored == expected;
+        }
+
+        static uint32_t checksum(std::string_view bytes) {
+            return static_cast<uint32_t>(hashWord(bytes));
+        }
+
+        static std::vector<char> readAll(std::string const& path) {
+            std::ifstream iff(path, std::ios_base::binary);
+            return std::vector<char>(std::istreambuf_iterator<char>(iff), std::istreambuf_iterator<char>());
+        }
+
+        static std::string directoryOf(std::string const& path) {
+            auto parent = std::filesystem::path(path).parent_path();
+            return parent.empty() ? "." : parent.string();
+        }
+
+        // Works for directories too, which is how a rename is made durable.
+        static void syncFile(std::string const& path) {
+            int file = ::open(path.c_str(), O_RDONLY);
+            bool synced = file != -1 && ::fsync(file) == 0;
+            if (file != -1) {
+                ::close(file);
+            }
+            if (!synced) {
+                throw std::runtime_error("Error: can't sync " + path);
+            }
+        }
+
+    protected:
+        WalConfig config;
+        int fd = -1;
+        std::vector<char> pending;
+        size_t logBytes = 0;
+        clock::time_point lastCommit;
+    };
+
+    // Dictionary decorator that journals successful mutations. The owner has to call `commit()`
+    // before acknowledging them, which BufferedWriter does through its before-flush hook.
+    template <class Dictionary>
+    class LoggedDictionary {
+    public:
+        explicit LoggedDictionary(WalConfig config) : log(std::move(config)) {
+            std::ifstream snapshot(log.snapshotPath());
+            if (snapshot) {
+                dict.load(snapshot);
+            }
+            log.replay([this](WriteAheadLog::RecordType type, std::string_view key, uint64_t value) {
+                if (type == WriteAheadLog::ADD) {
+                    dict.add(var{Key(key), value});
+                } else {
+                    dict.remove(key);
+                }
+            });
+        }
+
+        bool add(var const& v) {
+            if (!dict.add(v)) {
+                return false;
+            }
+            log.append(WriteAheadLog::ADD, v.first.view(), v.second);
+            afterMutation();
+            return true;
+        }
+
+        bool remove(std::string_view word) {
+            if (!dict.remove(word)) {
+                return false;
+            }
+            log.append(WriteAheadLog::REMOVE, word, 0);
+            afterMutation();
+            return true;
+        }
+
+        bool find(std::string_view word, uint64_t& value) {
+            return dict.find(word, value);
+        }
+
+        auto seek(std::string_view from) const
+            requires requires (Dictionary const& d) { d.seek(from); } {
+            return dict.seek(from);
+        }
+
+        TreeShape shape() const
+            requires requires (Dictionary const& d) { d.shape(); } {
+            return dict.shape();
+        }
+
+        void save(std::ostream& os) {
+            dict.save(os);
+        }
+
+        // A loaded dictionary replaces the logged history, so it becomes the new snapshot.
+        void load(std::istream& is) {
+            dict.load(is);
+            compact();
+        }
+
+        void print(std::ostream& os) {
+            dict.print(os);
+        }
+
+        void commit() {
+            log.commit();
+        }
+
+        // Commits once the batch is full or old enough; the server calls it after every
+        // command, so a lone write followed only by lookups still reaches the disk in time.
+        void commitIfDue() {
+            if (log.commitDue()) {
+                log.commit();
+            }
+        }
+
+        void close() {
+            log.close();
+        }
+
+        void compact() {
+            log.compact([this](std::ostream& os) {
+                dict.save(os);
+            });
+        }
+
+    protected:
+        void afterMutation() {
+            commitIfDue();
+            if (log.compactionDue()) {
+                compact();
+            }
+        }
+
+    protected:
+        Dictionary dict;
+        WriteAheadLog log;
+    };
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+#include <stats.hpp>
+
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocator in LAB2_STATS builds so `stats` can report allocation count and
+// live heap bytes. Every block carries its size in a 16-byte header, which keeps malloc alignment.
+
+namespace {
+
+    constexpr size_t HEADER = 16;
+
+    void* countedAlloc(size_t size) {
+        void* p = std::malloc(size + HEADER);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        *static_cast<size_t*>(p) = size;
+        da_lab2::stats().allocations.fetch_add(1, std::memory_order_relaxed);
+        da_lab2::stats().liveBytes.fetch_add(size, std::memory_order_relaxed);
+        return static_cast<char*>(p) + HEADER;
+    }
+
+    void countedFree(void* p) noexcept {
+        if (p == nullptr) {
+            return;
+        }
+        void* block = static_cast<char*>(p) - HEADER;
+        da_lab2::stats().liveBytes.fetch_sub(*static_cast<size_t*>(block), std::memory_order_relaxed);
+        std::free(block);
+    }
+
+}
+
+void* operator new(size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size) {
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept {
+    countedFree(p);
+}
+
+void operator delete[](void* p) noexcept {
+    countedFree(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    countedFree(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    countedFree(p);
+}
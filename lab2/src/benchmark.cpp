@@ -0,0 +1,267 @@
+#include <command.hpp>
+#include <compact_dictionary.hpp>
+#include <dictionary.hpp>
+#include <sharded_dictionary.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace da_lab2;
+
+struct Workload {
+    uint64_t seed = 1;
+    size_t operations = 200000;
+    size_t words = 50;
+    size_t wordLength = 7;
+    // Weights of +, - and lookup, as in genAndRunTests.py.
+    unsigned insertWeight = 40;
+    unsigned removeWeight = 10;
+    unsigned findWeight = 20;
+};
+
+struct BenchConfig {
+    size_t warmup = 1;
+    size_t repetitions = 5;
+    std::string_view backend = "all";
+    bool matrix = true;
+};
+
+std::vector<Command> generate(Workload const& w) {
+    std::mt19937_64 rng(w.seed);
+    std::uniform_int_distribution<size_t> length(1, w.wordLength);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> words(w.words);
+    for (auto& word : words) {
+        word.resize(length(rng));
+        for (auto& c : word) {
+            c = static_cast<char>(letter(rng));
+        }
+    }
+
+    std::uniform_int_distribution<size_t> pick(0, w.words - 1);
+    std::uniform_int_distribution<unsigned> kind(0, w.insertWeight + w.removeWeight + w.findWeight - 1);
+    std::vector<Command> commands(w.operations);
+    for (auto& c : commands) {
+        auto k = kind(rng);
+        c.word = words[pick(rng)];
+        if (k < w.insertWeight) {
+            c.type = CommandType::ADD;
+            c.value = rng();
+        } else if (k < w.insertWeight + w.removeWeight) {
+            c.type = CommandType::REMOVE;
+        } else {
+            c.type = CommandType::FIND;
+        }
+    }
+    return commands;
+}
+
+struct Latencies {
+    std::vector<uint64_t> byType[3];
+};
+
+size_t typeSlot(CommandType type) {
+    return type == CommandType::ADD ? 0 : type == CommandType::REMOVE ? 1 : 2;
+}
+
+uint64_t percentile(std::vector<uint64_t>& v, double p) {
+    if (v.empty()) {
+        return 0;
+    }
+    auto k = static_cast<size_t>(p * static_cast<double>(v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k), v.end());
+    return v[k];
+}
+
+volatile uint64_t benchSink;
+
+template <class Dictionary>
+double runOnce(std::vector<Command> const& commands, Latencies* latencies) {
+    using clock = std::chrono::steady_clock;
+    Dictionary dict;
+    uint64_t sink = 0;
+    auto start = clock::now();
+    for (auto const& c : commands) {
+        if (latencies == nullptr) {
+            sink += apply(dict, c).kind;
+            continue;
+        }
+        auto before = clock::now();
+        sink += apply(dict, c).kind;
+        auto after = clock::now();
+        latencies->byType[typeSlot(c.type)].push_back(
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count())
+        );
+    }
+    auto seconds = std::chrono::duration<double>(clock::now() - start).count();
+    benchSink = sink;
+    return seconds;
+}
+
+template <class Dictionary>
+void bench(std::string_view name, std::vector<Command> const& commands, BenchConfig const& config, bool& first) {
+    for (size_t i = 0; i < config.warmup; ++i) {
+        runOnce<Dictionary>(commands, nullptr);
+    }
+
+    // Throughput is taken from untimed runs, per-command latency from separate timed runs.
+    std::vector<double> throughput;
+    Latencies latencies;
+    for (size_t i = 0; i < config.repetitions; ++i) {
+        throughput.push_back(static_cast<double>(commands.size()) / runOnce<Dictionary>(commands, nullptr));
+        runOnce<Dictionary>(commands, &latencies);
+    }
+    std::sort(throughput.begin(), throughput.end());
+
+    std::cout << (first ? "" : ",\n") << "      {\"backend\": \"" << name << "\", "
+              << "\"ops_per_s\": " << static_cast<uint64_t>(throughput[throughput.size() / 2]);
+    constexpr char const* names[] = {"insert", "remove", "lookup"};
+    for (size_t t = 0; t < 3; ++t) {
+        auto& v = latencies.byType[t];
+        std::cout << ", \"" << names[t] << "\": {\"count\": " << v.size()
+                  << ", \"p50_ns\": " << percentile(v, 0.5)
+                  << ", \"p99_ns\": " << percentile(v, 0.99) << "}";
+    }
+    std::cout << "}";
+    first = false;
+}
+
+void runWorkload(Workload const& w, BenchConfig const& config, bool last) {
+    auto commands = generate(w);
+    std::cout << "  {\"seed\": " << w.seed << ", \"operations\": " << w.operations
+              << ", \"words\": " << w.words << ", \"word_length\": " << w.wordLength
+              << ", \"mix\": [" << w.insertWeight << ", " << w.removeWeight << ", " << w.findWeight << "]"
+              << ", \"results\": [\n";
+    bool first = true;
+    if (config.backend == "all" || config.backend == "flat") {
+        bench<FlatDictionary>("flat", commands, config, first);
+    }
+    if (config.backend == "all" || config.backend == "rbtree") {
+        bench<RBTreeDictionary>("rbtree", commands, config, first);
+    }
+    if (config.backend == "all" || config.backend == "compact") {
+        bench<CompactDictionary>("compact", commands, config, first);
+    }
+    if (config.backend == "all" || config.backend == "sharded") {
+        bench<ShardedDictionary<FlatDictionary>>("sharded", commands, config, first);
+    }
+    std::cout << "\n  ]}" << (last ? "\n" : ",\n");
+}
+
+bool parseArg(std::string_view arg, std::string_view name, uint64_t& value) {
+    if (!arg.starts_with(name)) {
+        return false;
+    }
+    value = std::strtoull(arg.data() + name.size(), nullptr, 10);
+    return true;
+}
+
+// `I/R/F` weights of --mix; false unless there are exactly three numbers.
+bool parseMix(std::string_view mix, Workload& w) {
+    unsigned weights[3] = {};
+    char const* p = mix.data();
+    char const* end = mix.data() + mix.size();
+    for (size_t i = 0; i < 3; ++i) {
+        if (i != 0 && (p == end || *p++ != '/')) {
+            return false;
+        }
+        if (p == end || *p < '0' || '9' < *p) {
+            return false;
+        }
+        char* next = nullptr;
+        weights[i] = static_cast<unsigned>(std::strtoul(p, &next, 10));
+        p = next;
+    }
+    if (p != end) {
+        return false;
+    }
+    w.insertWeight = weights[0];
+    w.removeWeight = weights[1];
+    w.findWeight = weights[2];
+    return true;
+}
+
+constexpr char const* USAGE =
+    "Usage: bench [--seed=N] [--ops=N] [--words=N] [--word-length=N] [--mix=I/R/F]\n"
+    "             [--warmup=N] [--repeat=N] [--backend=all|flat|rbtree|compact|sharded]\n";
+
+// Any workload argument replaces the default matrix with that single workload.
+int main(int argc, char* argv[]) {
+    Workload w;
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        uint64_t v = 0;
+        if (parseArg(arg, "--seed=", v)) {
+            w.seed = v;
+        } else if (parseArg(arg, "--ops=", v)) {
+            w.operations = v;
+            config.matrix = false;
+        } else if (parseArg(arg, "--words=", v)) {
+            w.words = v;
+            config.matrix = false;
+        } else if (parseArg(arg, "--word-length=", v)) {
+            w.wordLength = v;
+            config.matrix = false;
+        } else if (parseArg(arg, "--warmup=", v)) {
+            config.warmup = v;
+        } else if (parseArg(arg, "--repeat=", v)) {
+            config.repetitions = std::max<uint64_t>(v, 1);
+        } else if (arg.starts_with("--mix=")) {
+            if (!parseMix(arg.substr(6), w)) {
+                std::cerr << "Bad --mix, expected three weights I/R/F: " << arg << "\n" << USAGE;
+                return 1;
+            }
+            config.matrix = false;
+        } else if (arg.starts_with("--backend=")) {
+            config.backend = arg.substr(10);
+            constexpr std::string_view backends[] = {"all", "flat", "rbtree", "compact", "sharded"};
+            if (std::find(std::begin(backends), std::end(backends), config.backend) == std::end(backends)) {
+                std::cerr << "Unknown backend: " << arg << "\n" << USAGE;
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n" << USAGE;
+            return 1;
+        }
+    }
+    if (w.words == 0 || w.wordLength == 0 || w.insertWeight + w.removeWeight + w.findWeight == 0) {
+        std::cerr << "--words, --word-length and the sum of the --mix weights must be positive\n" << USAGE;
+        return 1;
+    }
+
+    std::vector<Workload> workloads;
+    if (!config.matrix) {
+        workloads.push_back(w);
+    } else {
+        constexpr unsigned mixes[][3] = {{40, 10, 20}, {10, 5, 85}, {70, 25, 5}};
+        for (size_t words : {size_t{50}, size_t{100000}}) {
+            for (size_t length : {size_t{7}, size_t{32}}) {
+                for (auto const& mix : mixes) {
+                    Workload next = w;
+                    next.words = words;
+                    next.wordLength = length;
+                    next.insertWeight = mix[0];
+                    next.removeWeight = mix[1];
+                    next.findWeight = mix[2];
+                    workloads.push_back(next);
+                }
+            }
+        }
+    }
+
+    std::cout << "[\n";
+    for (size_t i = 0; i < workloads.size(); ++i) {
+        runWorkload(workloads[i], config, i + 1 == workloads.size());
+    }
+    std::cout << "]\n";
+
+    return 0;
+}
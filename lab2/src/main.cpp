@@ -1,91 +1,123 @@
-#include <rb_tree.hpp>
+#include <command.hpp>
+#include <compact_dictionary.hpp>
+#include <dictionary.hpp>
+#include <fast_io.hpp>
+#include <parallel_driver.hpp>
+#include <sharded_dictionary.hpp>
+#include <write_ahead_log.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
-#include <fstream>
+#include <optional>
+#include <string_view>
 
-using namespace cust;
+using namespace da_lab2;
 
-struct var {
-    std::string first;
-    uint64_t second;
+struct Options {
+    size_t threads = 1;
+    std::string_view backend = "flat";
+    std::optional<WalConfig> wal;
 };
 
-bool operator==(var const& a, var const& b) {
-    return a.first == b.first;
+bool parseNumber(std::string_view arg, std::string_view prefix, size_t& value) {
+    if (!arg.starts_with(prefix)) {
+        return false;
+    }
+    value = std::strtoull(arg.data() + prefix.size(), nullptr, 10);
+    return true;
 }
 
-bool operator<(var const& a, var const& b) {
-    return a.first < b.first;
+Options parseOptions(int argc, char* argv[]) {
+    constexpr std::string_view backendPrefix = "--backend=";
+    constexpr std::string_view walPrefix = "--wal=";
+    Options options;
+    WalConfig wal;
+    size_t number = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        if (parseNumber(arg, "--threads=", number)) {
+            options.threads = number;
+        } else if (arg.starts_with(backendPrefix)) {
+            options.backend = arg.substr(backendPrefix.size());
+        } else if (arg.starts_with(walPrefix)) {
+            wal.path = arg.substr(walPrefix.size());
+        } else if (parseNumber(arg, "--wal-batch=", number)) {
+            wal.batchBytes = number;
+        } else if (parseNumber(arg, "--wal-interval-ms=", number)) {
+            wal.interval = std::chrono::milliseconds(number);
+        } else if (parseNumber(arg, "--wal-compact=", number)) {
+            wal.compactBytes = number;
+        }
+    }
+    if (!wal.path.empty()) {
+        options.wal = std::move(wal);
+    }
+    return options;
 }
 
-void lower(std::string& s) {
-    for (auto& c : s) {
-        if ('A' <= c && c <= 'Z') {
-            c += 'a' - 'A';
+template <class Dictionary>
+void serve(Options const& options, BufferedReader& in, BufferedWriter& out) {
+    if (options.wal) {
+        LoggedDictionary<Dictionary> dict(*options.wal);
+        out.setBeforeFlush([&dict] { dict.commit(); });
+        try {
+            Command command;
+            while (readCommand(in, command)) {
+                execute(dict, command, out);
+                dict.commitIfDue();
+            }
+            out.flush();
+        } catch (...) {
+            // Replies still buffered acknowledge mutations that never became durable.
+            out.setBeforeFlush(nullptr);
+            out.discard();
+            throw;
         }
+        out.setBeforeFlush(nullptr);
+        dict.close();
+        return;
     }
-}
 
-std::istream& operator>>(std::istream& iss, var& v) {
-    iss >> v.first >> v.second;
-    lower(v.first);
-    return iss;
-}
+    if (1 < options.threads) {
+        ShardedDictionary<Dictionary> dict(
+            std::max(options.threads, ShardedDictionary<Dictionary>::DEFAULT_SHARD_COUNT)
+        );
+        ParallelDriver<Dictionary>(dict, options.threads).run(in, out);
+        return;
+    }
 
-std::ostream& operator<<(std::ostream& os, var& v) {
-    return os << v.first << " " << v.second;
+    Dictionary dict;
+    Command command;
+    while (readCommand(in, command)) {
+        execute(dict, command, out);
+    }
 }
 
-int main() {   
-    RBTree<var> tree;
+int main(int argc, char* argv[]) {
+    BufferedReader in(stdin);
+    BufferedWriter out(stdout);
+    // Replies leave before the server waits for more commands, not only when 64 KiB pile up.
+    in.setBeforeRefill([&out] { out.flush(); });
 
-    std::string word;
-    while (std::cin >> word) {
-        if (word == "+") {
-            var v; std::cin >> v;
-            try {
-                tree.add(v);
-                std::cout << "OK\n";  
-            } catch (...) {
-                std::cout << "Exist\n";
-            }
-        } else if (word == "-") {
-            std::cin >> word;
-            lower(word);
-            var v{word, 0};
-            try {
-                tree.remove(v);
-                std::cout << "OK\n";
-            } catch (...) {
-                std::cout << "NoSuchWord\n";
-            }
-        } else if (word == "!") {
-            std::string filename;
-            std::cin >> word; std::cin.get();
-            std::getline(std::cin, filename);
-            if (word == "Save") {
-                std::ofstream off(filename, std::ios_base::trunc);
-                tree.saveInStream(off);
-                off.close();
-            } else {
-                std::ifstream iff(filename);
-                tree = std::move(RBTree<var>::readFromStream(iff));
-                iff.close();
-            }
-            std::cout << "OK\n";
-        } else if (word == "print") {
-            tree.printTree(std::cout);
-            std::cout << "\n";
+    auto options = parseOptions(argc, argv);
+    if (options.wal && 1 < options.threads) {
+        std::cerr << "Error: --wal is only supported with a single thread\n";
+        return 1;
+    }
+    try {
+        if (options.backend == "rbtree") {
+            serve<RBTreeDictionary>(options, in, out);
+        } else if (options.backend == "compact") {
+            serve<CompactDictionary>(options, in, out);
         } else {
-            try {
-                lower(word);
-                auto v = tree.find(var{word, 0});
-                std::cout << "OK: " << v->second << "\n";
-            } catch (...) {
-                std::cout << "NoSuchWord\n";
-            }
+            serve<FlatDictionary>(options, in, out);
         }
+    } catch (std::exception const& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+
+#include <chunked_arena.hpp>
+#include <flat_rb_tree.hpp>
+
+#include <bit>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+using namespace da_lab2;
+
+// Exposes the node array so the red-black invariants can be checked from outside.
+template <template <class...> class Storage = std::vector>
+class FlatRBTreeTest : public FlatRBTree<int, std::less<>, Storage> {
+public:
+    using Base = FlatRBTree<int, std::less<>, Storage>;
+    using typename Base::index;
+    using Base::NIL;
+
+    static void checkCapacity(size_t slots) {
+        Base::checkCapacity(slots);
+    }
+
+    // Asserts the root and NIL are black, no red node has a red child, every path has the same
+    // number of black nodes, parent links match, the order is strict and the free list holds
+    // exactly the slots not in the tree.
+    void checkInvariants() const {
+        ASSERT_FALSE(this->isRed(NIL));
+        ASSERT_FALSE(this->isRed(this->root));
+        if (this->root != NIL) {
+            ASSERT_EQ(this->parentOf(this->root), NIL);
+        }
+        size_t nodes = 0;
+        blackHeight(this->root, nodes);
+        ASSERT_EQ(nodes, this->size());
+
+        std::vector<int> values;
+        this->forEach([&values](int value) {
+            values.push_back(value);
+        });
+        ASSERT_EQ(values.size(), this->size());
+        for (size_t i = 1; i < values.size(); ++i) {
+            ASSERT_LT(values[i - 1], values[i]);
+        }
+
+        size_t free = 0;
+        for (index i = this->freeList; i != NIL; i = this->nodes[i].right) {
+            ++free;
+        }
+        ASSERT_EQ(free, this->freeSlots());
+    }
+
+protected:
+    size_t blackHeight(index i, size_t& nodes) const {
+        if (i == NIL) {
+            return 1;
+        }
+        ++nodes;
+        index left = this->nodes[i].left;
+        index right = this->nodes[i].right;
+        if (this->isRed(i)) {
+            EXPECT_FALSE(this->isRed(left)) << "red node " << i << " has a red left child";
+            EXPECT_FALSE(this->isRed(right)) << "red node " << i << " has a red right child";
+        }
+        if (left != NIL) {
+            EXPECT_EQ(this->parentOf(left), i);
+        }
+        if (right != NIL) {
+            EXPECT_EQ(this->parentOf(right), i);
+        }
+        size_t leftHeight = blackHeight(left, nodes);
+        size_t rightHeight = blackHeight(right, nodes);
+        EXPECT_EQ(leftHeight, rightHeight) << "black heights differ below node " << i;
+        return leftHeight + (this->isRed(i) ? 0 : 1);
+    }
+};
+
+template <class Tree>
+void expectContent(Tree const& tree, std::set<int> const& expected) {
+    std::vector<int> values;
+    tree.forEach([&values](int value) {
+        values.push_back(value);
+    });
+    ASSERT_EQ(values, std::vector<int>(expected.begin(), expected.end()));
+}
+
+template <class Tree>
+void randomAddRemove(unsigned seed, int range, size_t steps) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> key(0, range - 1);
+    Tree tree;
+    std::set<int> expected;
+    for (size_t step = 0; step < steps; ++step) {
+        int k = key(rng);
+        if (rng() % 3 != 0) {
+            ASSERT_EQ(tree.add(k), expected.insert(k).second);
+        } else {
+            ASSERT_EQ(tree.remove(k), expected.erase(k) == 1);
+        }
+        if (step % 97 == 0) {
+            tree.checkInvariants();
+        }
+    }
+    tree.checkInvariants();
+    expectContent(tree, expected);
+    for (int k = 0; k < range; ++k) {
+        ASSERT_EQ(tree.find(k) != nullptr, expected.count(k) == 1);
+    }
+}
+
+TEST(FlatRBTreeTests, emptyTree) {
+    FlatRBTreeTest<> tree;
+    tree.checkInvariants();
+    EXPECT_EQ(tree.size(), 0u);
+    EXPECT_FALSE(tree.remove(1));
+    EXPECT_EQ(tree.find(1), nullptr);
+    EXPECT_FALSE(tree.lowerBound(0).valid());
+}
+
+TEST(FlatRBTreeTests, ascendingAndDescendingAdds) {
+    FlatRBTreeTest<> tree;
+    for (int k = 0; k < 1000; ++k) {
+        ASSERT_TRUE(tree.add(k));
+    }
+    for (int k = -1; -1000 < k; --k) {
+        ASSERT_TRUE(tree.add(k));
+    }
+    ASSERT_FALSE(tree.add(500));
+    tree.checkInvariants();
+    EXPECT_EQ(tree.size(), 1999u);
+    // A red-black tree of n nodes is at most 2 log2(n + 1) high.
+    EXPECT_LE(tree.shape().height, 22u);
+}
+
+TEST(FlatRBTreeTests, randomAddRemove) {
+    for (unsigned seed = 1; seed <= 20; ++seed) {
+        randomAddRemove<FlatRBTreeTest<>>(seed, seed % 2 == 0 ? 64 : 5000, 20000);
+    }
+}
+
+TEST(FlatRBTreeTests, randomAddRemoveInChunkedArena) {
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        randomAddRemove<FlatRBTreeTest<ChunkedArena>>(seed, 20000, 30000);
+    }
+}
+
+TEST(FlatRBTreeTests, removeEverythingReusesSlots) {
+    FlatRBTreeTest<> tree;
+    for (int k = 0; k < 300; ++k) {
+        tree.add(k * 7 % 300);
+    }
+    for (int k = 0; k < 300; ++k) {
+        ASSERT_TRUE(tree.remove(k * 11 % 300));
+        tree.checkInvariants();
+    }
+    EXPECT_EQ(tree.size(), 0u);
+    EXPECT_EQ(tree.freeSlots(), 300u);
+    for (int k = 0; k < 300; ++k) {
+        tree.add(k);
+    }
+    tree.checkInvariants();
+    EXPECT_EQ(tree.freeSlots(), 0u);
+}
+
+TEST(FlatRBTreeTests, assignBuildsBalancedTree) {
+    for (size_t n : std::vector<size_t>{0, 1, 2, 3, 7, 8, 100, 1023, 1024, 1025, 5000}) {
+        FlatRBTreeTest<> tree;
+        std::vector<int> values;
+        std::set<int> expected;
+        for (size_t i = 0; i < n; ++i) {
+            int k = static_cast<int>((i * 7919) % 10007);
+            values.push_back(k);
+            values.push_back(k);
+            expected.insert(k);
+        }
+        tree.assign(values);
+        tree.checkInvariants();
+        expectContent(tree, expected);
+        EXPECT_EQ(tree.shape().height, static_cast<size_t>(std::bit_width(expected.size())));
+
+        // The built tree must survive further updates.
+        std::mt19937 rng(static_cast<unsigned>(n));
+        for (int step = 0; step < 2000; ++step) {
+            int k = static_cast<int>(rng() % 10007);
+            if (step % 2 == 0) {
+                ASSERT_EQ(tree.add(k), expected.insert(k).second);
+            } else {
+                ASSERT_EQ(tree.remove(k), expected.erase(k) == 1);
+            }
+        }
+        tree.checkInvariants();
+        expectContent(tree, expected);
+    }
+}
+
+TEST(FlatRBTreeTests, insertBatchSmallAndLarge) {
+    std::mt19937 rng(7);
+    FlatRBTreeTest<> tree;
+    std::set<int> expected;
+    for (int round = 0; round < 60; ++round) {
+        // Alternates batches that go through `add` with ones that are merged and rebuilt.
+        size_t size = round % 2 == 0 ? 1 + rng() % 4 : 100 + rng() % 3000;
+        std::vector<int> batch;
+        size_t added = 0;
+        std::set<int> seen;
+        for (size_t i = 0; i < size; ++i) {
+            int k = static_cast<int>(rng() % 50000);
+            batch.push_back(k);
+            if (seen.insert(k).second && expected.count(k) == 0) {
+                ++added;
+            }
+        }
+        expected.insert(batch.begin(), batch.end());
+        ASSERT_EQ(tree.insertBatch(batch), added);
+        tree.checkInvariants();
+        expectContent(tree, expected);
+        for (int i = 0; i < 50; ++i) {
+            int k = static_cast<int>(rng() % 50000);
+            ASSERT_EQ(tree.remove(k), expected.erase(k) == 1);
+        }
+        tree.checkInvariants();
+    }
+}
+
+TEST(FlatRBTreeTests, lowerBoundWalksInOrder) {
+    FlatRBTreeTest<> tree;
+    for (int k = 0; k < 100; k += 2) {
+        tree.add(k);
+    }
+    auto it = tree.lowerBound(31);
+    ASSERT_TRUE(it.valid());
+    EXPECT_EQ(*it, 32);
+    int expected = 32;
+    for (; it.valid(); it.next(), expected += 2) {
+        ASSERT_EQ(*it, expected);
+    }
+    EXPECT_EQ(expected, 100);
+    EXPECT_FALSE(tree.lowerBound(99).valid());
+}
+
+TEST(FlatRBTreeTests, capacityIsChecked) {
+    using Tree = FlatRBTreeTest<>;
+    EXPECT_NO_THROW(Tree::checkCapacity(Tree::MAX_NODES));
+    EXPECT_THROW(Tree::checkCapacity(Tree::MAX_NODES + 1), std::length_error);
+    EXPECT_EQ(Tree::MAX_NODES, (size_t{1} << 31) - 1);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+
+#include <compact_dictionary.hpp>
+#include <write_ahead_log.hpp>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace da_lab2;
+
+using Record = std::tuple<WriteAheadLog::RecordType, std::string, uint64_t>;
+
+class WriteAheadLogTest : public WriteAheadLog {
+public:
+    using WriteAheadLog::WriteAheadLog;
+
+    static bool _decode(std::vector<char> const& log, size_t& pos, Record& record) {
+        RecordType type;
+        std::string_view key;
+        uint64_t value = 0;
+        if (!decode(log, pos, type, key, value)) {
+            return false;
+        }
+        record = {type, std::string(key), value};
+        return true;
+    }
+
+    std::vector<char> const& _pending() const {
+        return pending;
+    }
+
+    std::vector<Record> replayAll() {
+        std::vector<Record> records;
+        replay([&records](RecordType type, std::string_view key, uint64_t value) {
+            records.emplace_back(type, std::string(key), value);
+        });
+        return records;
+    }
+};
+
+// Each test gets its own directory for the log and the snapshot.
+class WalFiles : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto const* test = ::testing::UnitTest::GetInstance()->current_test_info();
+        directory = std::filesystem::temp_directory_path()
+            / ("da_lab2_" + std::to_string(::getpid()) + "_" + test->name());
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        config.path = (directory / "dict.wal").string();
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    std::vector<Record> writeLog(std::vector<Record> const& records) {
+        WriteAheadLogTest log(config);
+        log.replayAll();
+        for (auto const& [type, key, value] : records) {
+            log.append(type, key, value);
+        }
+        log.close();
+        return records;
+    }
+
+    std::vector<char> logBytes() const {
+        std::ifstream iff(config.path, std::ios_base::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(iff), std::istreambuf_iterator<char>());
+    }
+
+    void setLogBytes(std::vector<char> const& bytes) const {
+        std::ofstream off(config.path, std::ios_base::binary | std::ios_base::trunc);
+        off.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    std::filesystem::path directory;
+    WalConfig config;
+};
+
+std::vector<Record> sampleRecords() {
+    return {
+        {WriteAheadLog::ADD, "a", 1},
+        {WriteAheadLog::ADD, "word", 18446744073709551615ull},
+        {WriteAheadLog::REMOVE, "a", 0},
+        {WriteAheadLog::ADD, std::string(256, 'z'), 42},
+        {WriteAheadLog::REMOVE, "missing", 0},
+    };
+}
+
+TEST(WriteAheadLogTests, decodeNeedsTheWholeRecord) {
+    WalConfig config;
+    for (auto const& [type, key, value] : sampleRecords()) {
+        WriteAheadLogTest log(config);
+        log.append(type, key, value);
+        std::vector<char> bytes = log._pending();
+        Record record;
+        for (size_t size = 0; size < bytes.size(); ++size) {
+            std::vector<char> prefix(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(size));
+            size_t pos = 0;
+            ASSERT_FALSE(WriteAheadLogTest::_decode(prefix, pos, record)) << key << ", " << size << " bytes";
+        }
+        size_t pos = 0;
+        ASSERT_TRUE(WriteAheadLogTest::_decode(bytes, pos, record));
+        EXPECT_EQ(pos, bytes.size());
+        EXPECT_EQ(record, Record(type, key, value));
+    }
+}
+
+TEST(WriteAheadLogTests, decodeChecksEveryByte) {
+    WalConfig config;
+    WriteAheadLogTest log(config);
+    log.append(WriteAheadLog::ADD, "checksum", 123456789);
+    std::vector<char> bytes = log._pending();
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        for (int bit = 0; bit < 8; ++bit) {
+            auto damaged = bytes;
+            damaged[i] = static_cast<char>(damaged[i] ^ (1 << bit));
+            size_t pos = 0;
+            Record record;
+            ASSERT_FALSE(WriteAheadLogTest::_decode(damaged, pos, record)) << "byte " << i << ", bit " << bit;
+        }
+    }
+}
+
+TEST_F(WalFiles, replayReturnsCommittedRecords) {
+    auto records = writeLog(sampleRecords());
+    WriteAheadLogTest log(config);
+    EXPECT_EQ(log.replayAll(), records);
+}
+
+TEST_F(WalFiles, tornTailIsCutOff) {
+    auto records = writeLog(sampleRecords());
+    auto complete = logBytes();
+    WriteAheadLogTest one(WalConfig{});
+    one.append(WriteAheadLog::ADD, "torn", 7);
+    auto record = one._pending();
+
+    for (size_t size = 1; size < record.size(); ++size) {
+        auto torn = complete;
+        torn.insert(torn.end(), record.begin(), record.begin() + static_cast<std::ptrdiff_t>(size));
+        setLogBytes(torn);
+        {
+            WriteAheadLogTest log(config);
+            ASSERT_EQ(log.replayAll(), records) << size << " bytes torn";
+        }
+        ASSERT_EQ(logBytes(), complete) << size << " bytes torn";
+    }
+
+    // Records appended after the cut follow the last complete one.
+    auto torn = complete;
+    torn.insert(torn.end(), record.begin(), record.end() - 1);
+    setLogBytes(torn);
+    records.emplace_back(WriteAheadLog::ADD, "after", 9);
+    {
+        WriteAheadLogTest log(config);
+        log.replayAll();
+        log.append(WriteAheadLog::ADD, "after", 9);
+    }
+    WriteAheadLogTest log(config);
+    EXPECT_EQ(log.replayAll(), records);
+}
+
+TEST_F(WalFiles, checksumMismatchStopsReplay) {
+    auto records = sampleRecords();
+    writeLog({records[0]});
+    size_t first = logBytes().size();
+    writeLog({records.begin() + 1, records.end()});
+
+    auto bytes = logBytes();
+    // The last byte of the second record belongs to its checksum.
+    WriteAheadLogTest second(WalConfig{});
+    second.append(std::get<0>(records[1]), std::get<1>(records[1]), std::get<2>(records[1]));
+    bytes[first + second._pending().size() - 1] ^= 1;
+    setLogBytes(bytes);
+
+    WriteAheadLogTest log(config);
+    EXPECT_EQ(log.replayAll(), std::vector<Record>({records[0]}));
+    log.close();
+    EXPECT_EQ(logBytes().size(), first);
+}
+
+TEST_F(WalFiles, commitIsDueOnBatchSize) {
+    config.batchBytes = 64;
+    config.interval = std::chrono::hours(1);
+    WriteAheadLogTest log(config);
+    log.replayAll();
+    EXPECT_FALSE(log.commitDue());
+    log.append(WriteAheadLog::ADD, "short", 1);
+    EXPECT_FALSE(log.commitDue());
+    log.append(WriteAheadLog::ADD, std::string(64, 'k'), 2);
+    EXPECT_TRUE(log.commitDue());
+    log.commit();
+    EXPECT_FALSE(log.commitDue());
+}
+
+TEST_F(WalFiles, replayAfterCompact) {
+    config.batchBytes = 256;
+    config.compactBytes = 4096;
+    std::map<std::string, uint64_t> expected;
+    std::mt19937 rng(11);
+    {
+        LoggedDictionary<CompactDictionary> dict(config);
+        for (int step = 0; step < 3000; ++step) {
+            std::string key = "k" + std::to_string(rng() % 500);
+            if (rng() % 3 != 0) {
+                uint64_t value = rng();
+                ASSERT_EQ(dict.add(var{Key(key), value}), expected.emplace(key, value).second);
+            } else {
+                ASSERT_EQ(dict.remove(key), expected.erase(key) == 1);
+            }
+            dict.commitIfDue();
+        }
+        dict.close();
+    }
+    // Compaction ran several times and left a snapshot next to a short log.
+    ASSERT_TRUE(std::filesystem::exists(config.path + ".snapshot"));
+    EXPECT_LT(std::filesystem::file_size(config.path), config.compactBytes + 2 * config.batchBytes);
+    EXPECT_FALSE(std::filesystem::exists(config.path + ".snapshot.tmp"));
+
+    LoggedDictionary<CompactDictionary> dict(config);
+    for (int k = 0; k < 500; ++k) {
+        std::string key = "k" + std::to_string(k);
+        uint64_t value = 0;
+        bool found = dict.find(key, value);
+        auto it = expected.find(key);
+        ASSERT_EQ(found, it != expected.end()) << key;
+        if (found) {
+            ASSERT_EQ(value, it->second) << key;
+        }
+    }
+}
+
+TEST_F(WalFiles, compactEmptiesTheLog) {
+    {
+        LoggedDictionary<CompactDictionary> dict(config);
+        dict.add(var{Key("kept"), 1});
+        dict.add(var{Key("gone"), 2});
+        dict.remove("gone");
+        dict.commit();
+        dict.compact();
+        dict.add(var{Key("later"), 3});
+        dict.close();
+    }
+    WriteAheadLogTest log(config);
+    EXPECT_EQ(log.replayAll(), std::vector<Record>({{WriteAheadLog::ADD, "later", 3}}));
+    std::ifstream snapshot(config.path + ".snapshot");
+    std::string text((std::istreambuf_iterator<char>(snapshot)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(text, "kept 1\n");
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
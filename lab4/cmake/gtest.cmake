@@ -0,0 +1,20 @@
+set(LAB4_GTEST_VERSION 1.12.1)
+set(LAB4_GTEST_REPOSITORY https://github.com/google/googletest.git)
+
+find_package(GTest ${LAB4_GTEST_VERSION})
+
+if (GTest_FOUND)
+    message(STATUS "Found GTest ${GTest_VERSION}: ${GTest_DIR}")
+else()
+    message(STATUS
+        "GTest ${LAB4_GTEST_VERSION} will be fetched from GitHub: ${LAB4_GTEST_REPOSITORY}")
+
+    include(FetchContent)
+    FetchContent_Declare(GTest
+        GIT_REPOSITORY
+            ${LAB4_GTEST_REPOSITORY}
+        GIT_TAG
+            release-${LAB4_GTEST_VERSION}
+    )
+    FetchContent_MakeAvailable(GTest)
+endif()
@@ -0,0 +1,166 @@
+#ifndef ADAPTIVE_TEXT_HPP
+#define ADAPTIVE_TEXT_HPP
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Dense renumbering of up to 2^16 distinct 32-bit tokens in order of first appearance.
+    class AlphabetMap {
+    public:
+        static constexpr size_t LIMIT = size_t{1} << 16;
+        static constexpr uint32_t FULL = UINT32_MAX;
+
+        AlphabetMap() : direct(DIRECT, EMPTY), slots(INITIAL_SLOTS, EMPTY) {}
+
+        size_t size() const {
+            return tokens.size();
+        }
+
+        uint32_t decode(uint32_t code) const {
+            return tokens[code];
+        }
+
+        // Code of `token`, assigning the next one on first sight; FULL once LIMIT codes are taken.
+        // Small token values, the common case, skip hashing through a direct table.
+        uint32_t encode(uint32_t token) {
+            if (token < DIRECT) {
+                auto& code = direct[token];
+                if (code == EMPTY && tokens.size() < LIMIT) {
+                    code = static_cast<uint32_t>(tokens.size());
+                    tokens.push_back(token);
+                }
+                return code == EMPTY ? FULL : code;
+            }
+            for (size_t i = slot(token);; i = (i + 1) & (slots.size() - 1)) {
+                if (slots[i] == EMPTY) {
+                    if (tokens.size() == LIMIT) {
+                        return FULL;
+                    }
+                    slots[i] = static_cast<uint32_t>(tokens.size());
+                    tokens.push_back(token);
+                    ++hashed;
+                    if (slots.size() < 2 * hashed) {
+                        grow();
+                    }
+                    return static_cast<uint32_t>(tokens.size() - 1);
+                }
+                if (tokens[slots[i]] == token) {
+                    return slots[i];
+                }
+            }
+        }
+
+    protected:
+        static constexpr uint32_t DIRECT = 1 << 16;
+        static constexpr size_t INITIAL_SLOTS = 1024;
+        static constexpr uint32_t EMPTY = UINT32_MAX;
+
+        size_t slot(uint32_t token) const {
+            return static_cast<size_t>((uint64_t{token} * 0x9e3779b97f4a7c15ull) >> 40) & (slots.size() - 1);
+        }
+
+        void grow() {
+            slots.assign(slots.size() * 2, EMPTY);
+            for (size_t code = 0; code < tokens.size(); ++code) {
+                if (tokens[code] < DIRECT) {
+                    continue;
+                }
+                size_t i = slot(tokens[code]);
+                while (slots[i] != EMPTY) {
+                    i = (i + 1) & (slots.size() - 1);
+                }
+                slots[i] = static_cast<uint32_t>(code);
+            }
+        }
+
+    protected:
+        std::vector<uint32_t> direct;
+        std::vector<uint32_t> slots;
+        std::vector<uint32_t> tokens;
+        size_t hashed = 0;
+    };
+
+    // Pattern and text stored as narrow as their joint alphabet allows. Tokens are encoded into
+    // 16-bit codes while they are parsed; if the alphabet outgrows 2^16 the codes are decoded
+    // back once and the rest is stored raw. `visit` hands out uint8_t, uint16_t or uint32_t
+    // vectors, so the search is compiled for each width.
+    class AdaptiveText {
+    public:
+        explicit AdaptiveText(std::vector<uint32_t> const& pattern) : rawPattern(pattern) {
+            for (auto token : pattern) {
+                auto code = codes.encode(token);
+                if (code == AlphabetMap::FULL) {
+                    wide = true;
+                    narrowPattern = {};
+                    return;
+                }
+                narrowPattern.push_back(static_cast<uint16_t>(code));
+            }
+        }
+
+        size_t size() const {
+            return wide ? rawText.size() : narrow.size();
+        }
+
+        void push_back(uint32_t token) {
+            if (wide) {
+                rawText.push_back(token);
+            } else {
+                push(codes.encode(token), token);
+            }
+        }
+
+        // Calls `search(pattern, text)` with both vectors of the narrowest width that fits.
+        template <class F>
+        void visit(F&& search) {
+            if (wide) {
+                search(rawPattern, rawText);
+            } else if (codes.size() <= size_t{1} << 8) {
+                auto pattern = narrowTo<uint8_t>(narrowPattern);
+                auto text = narrowTo<uint8_t>(narrow);
+                narrow = {};
+                search(pattern, text);
+            } else {
+                search(narrowPattern, narrow);
+            }
+        }
+
+    protected:
+        void push(uint32_t code, uint32_t token) {
+            if (code != AlphabetMap::FULL) {
+                narrow.push_back(static_cast<uint16_t>(code));
+                return;
+            }
+            wide = true;
+            rawText.reserve(narrow.size() * 2);
+            for (auto c : narrow) {
+                rawText.push_back(codes.decode(c));
+            }
+            rawText.push_back(token);
+            narrow = {};
+        }
+
+        template <class Narrow>
+        static std::vector<Narrow> narrowTo(std::vector<uint16_t> const& v) {
+            std::vector<Narrow> result(v.size());
+            for (size_t i = 0; i < v.size(); ++i) {
+                result[i] = static_cast<Narrow>(v[i]);
+            }
+            return result;
+        }
+
+    protected:
+        AlphabetMap codes;
+        bool wide = false;
+        std::vector<uint32_t> rawPattern;
+        std::vector<uint16_t> narrowPattern;
+        std::vector<uint16_t> narrow;
+        std::vector<uint32_t> rawText;
+    };
+
+}
+
+#endif
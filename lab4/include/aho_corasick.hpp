@@ -0,0 +1,158 @@
+#ifndef AHO_CORASICK_HPP
+#define AHO_CORASICK_HPP
+
+#include <algorithm>
+#include <cinttypes>
+#include <utility>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Aho-Corasick automaton over an arbitrary integer alphabet. Transitions are kept sparse: the
+    // edges of all nodes live in two flat arrays sorted by token within each node, so a 32-bit
+    // alphabet costs only as much as the patterns themselves.
+    template <class T>
+    class AhoCorasick {
+    public:
+        static constexpr uint32_t ROOT = 0;
+
+        // Pattern ids are indices in `patterns`; empty patterns are accepted but never match.
+        explicit AhoCorasick(std::vector<std::vector<T>> const& patterns) {
+            buildTrie(patterns);
+            buildLinks();
+        }
+
+        size_t patternCount() const {
+            return lengths.size();
+        }
+
+        size_t nodeCount() const {
+            return fail.size();
+        }
+
+        uint32_t step(uint32_t state, T token) const {
+            while (true) {
+                auto next = child(state, token);
+                if (next != NONE) {
+                    return next;
+                }
+                if (state == ROOT) {
+                    return ROOT;
+                }
+                state = fail[state];
+            }
+        }
+
+        // Calls `onMatch(patternId, patternLength)` for every pattern ending in `state`.
+        template <class F>
+        void forEachMatch(uint32_t state, F&& onMatch) const {
+            if (terminalStart[state] == terminalStart[state + 1]) {
+                state = dictionary[state];
+            }
+            for (; state != ROOT; state = dictionary[state]) {
+                for (auto i = terminalStart[state]; i < terminalStart[state + 1]; ++i) {
+                    onMatch(terminalIds[i], lengths[terminalIds[i]]);
+                }
+            }
+        }
+
+        // Calls `onMatch(patternId, start)` for every occurrence, in order of the end offset.
+        template <class F>
+        void search(std::vector<T> const& text, F&& onMatch) const {
+            uint32_t state = ROOT;
+            for (size_t i = 0; i < text.size(); ++i) {
+                state = step(state, text[i]);
+                forEachMatch(state, [&](size_t id, size_t length) {
+                    onMatch(id, i + 1 - length);
+                });
+            }
+        }
+
+    protected:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        uint32_t child(uint32_t state, T token) const {
+            auto first = edgeTokens.begin() + edgeStart[state];
+            auto last = edgeTokens.begin() + edgeStart[state + 1];
+            auto it = std::lower_bound(first, last, token);
+            if (it == last || *it != token) {
+                return NONE;
+            }
+            return edgeTargets[static_cast<size_t>(it - edgeTokens.begin())];
+        }
+
+        void buildTrie(std::vector<std::vector<T>> const& patterns) {
+            std::vector<std::vector<std::pair<T, uint32_t>>> edges(1);
+            std::vector<std::vector<uint32_t>> terminals(1);
+            for (size_t id = 0; id < patterns.size(); ++id) {
+                lengths.push_back(patterns[id].size());
+                if (patterns[id].empty()) {
+                    continue;
+                }
+                uint32_t state = ROOT;
+                for (auto const& token : patterns[id]) {
+                    auto& out = edges[state];
+                    auto it = std::lower_bound(out.begin(), out.end(), token, [](auto const& e, T t) {
+                        return e.first < t;
+                    });
+                    if (it == out.end() || it->first != token) {
+                        auto created = static_cast<uint32_t>(edges.size());
+                        it = out.insert(it, {token, created});
+                        state = created;
+                        edges.emplace_back();
+                        terminals.emplace_back();
+                    } else {
+                        state = it->second;
+                    }
+                }
+                terminals[state].push_back(static_cast<uint32_t>(id));
+            }
+
+            edgeStart.assign(edges.size() + 1, 0);
+            terminalStart.assign(edges.size() + 1, 0);
+            for (size_t s = 0; s < edges.size(); ++s) {
+                edgeStart[s + 1] = edgeStart[s] + static_cast<uint32_t>(edges[s].size());
+                terminalStart[s + 1] = terminalStart[s] + static_cast<uint32_t>(terminals[s].size());
+                for (auto const& [token, target] : edges[s]) {
+                    edgeTokens.push_back(token);
+                    edgeTargets.push_back(target);
+                }
+                terminalIds.insert(terminalIds.end(), terminals[s].begin(), terminals[s].end());
+            }
+        }
+
+        // Failure links and dictionary links (nearest proper suffix that ends a pattern), in BFS order.
+        void buildLinks() {
+            fail.assign(edgeStart.size() - 1, ROOT);
+            dictionary.assign(fail.size(), ROOT);
+            std::vector<uint32_t> queue;
+            queue.reserve(fail.size());
+            queue.push_back(ROOT);
+            for (size_t head = 0; head < queue.size(); ++head) {
+                auto s = queue[head];
+                for (auto e = edgeStart[s]; e < edgeStart[s + 1]; ++e) {
+                    auto target = edgeTargets[e];
+                    if (s != ROOT) {
+                        fail[target] = step(fail[s], edgeTokens[e]);
+                    }
+                    auto f = fail[target];
+                    dictionary[target] = terminalStart[f] != terminalStart[f + 1] ? f : dictionary[f];
+                    queue.push_back(target);
+                }
+            }
+        }
+
+    protected:
+        std::vector<uint32_t> edgeStart;
+        std::vector<T> edgeTokens;
+        std::vector<uint32_t> edgeTargets;
+        std::vector<uint32_t> terminalStart;
+        std::vector<uint32_t> terminalIds;
+        std::vector<uint32_t> fail;
+        std::vector<uint32_t> dictionary;
+        std::vector<size_t> lengths;
+    };
+
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef BUFFERED_WRITER_HPP
+#define BUFFERED_WRITER_HPP
+
+#include <text_position.hpp>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Collects output in a large block and hands it to stdio only when the block is full or on
+    // an explicit flush, instead of flushing per answer line.
+    class BufferedWriter {
+    public:
+        static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+        explicit BufferedWriter(std::FILE* file, size_t blockSize = BLOCK_SIZE)
+            : file(file), buffer(blockSize) {}
+
+        BufferedWriter(BufferedWriter const&) = delete;
+        BufferedWriter& operator=(BufferedWriter const&) = delete;
+
+        ~BufferedWriter() {
+            flush();
+        }
+
+        BufferedWriter& operator<<(std::string_view s) {
+            if (buffer.size() - size < s.size()) {
+                flush();
+                if (buffer.size() < s.size()) {
+                    std::fwrite(s.data(), 1, s.size(), file);
+                    return *this;
+                }
+            }
+            std::memcpy(buffer.data() + size, s.data(), s.size());
+            size += s.size();
+            return *this;
+        }
+
+        BufferedWriter& operator<<(char c) {
+            if (size == buffer.size()) {
+                flush();
+            }
+            buffer[size++] = c;
+            return *this;
+        }
+
+        // Digits are produced two at a time from a table.
+        BufferedWriter& operator<<(uint64_t value) {
+            static constexpr char pairs[] =
+                "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                "8081828384858687888990919293949596979899";
+            char digits[20];
+            char* p = digits + sizeof(digits);
+            while (100 <= value) {
+                auto pair = static_cast<size_t>(value % 100) * 2;
+                value /= 100;
+                *--p = pairs[pair + 1];
+                *--p = pairs[pair];
+            }
+            if (10 <= value) {
+                auto pair = static_cast<size_t>(value) * 2;
+                *--p = pairs[pair + 1];
+                *--p = pairs[pair];
+            } else {
+                *--p = static_cast<char>('0' + value);
+            }
+            return *this << std::string_view(p, static_cast<size_t>(digits + sizeof(digits) - p));
+        }
+
+        // One answer line: "line, word".
+        BufferedWriter& operator<<(TextPosition const& position) {
+            return *this << uint64_t{position.line} << std::string_view(", ") << uint64_t{position.word} << '\n';
+        }
+
+        void flush() {
+            if (size != 0) {
+                std::fwrite(buffer.data(), 1, size, file);
+                size = 0;
+            }
+            std::fflush(file);
+        }
+
+    protected:
+        std::FILE* file;
+        std::vector<char> buffer;
+        size_t size = 0;
+    };
+
+}
+
+#endif
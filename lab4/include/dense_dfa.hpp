@@ -0,0 +1,112 @@
+#ifndef DENSE_DFA_HPP
+#define DENSE_DFA_HPP
+
+#include <token_table.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace da_lab4 {
+
+    // The KMP automaton compiled into a dense `state x symbol -> state` table, so no failure
+    // links are walked. Byte tokens, the width AdaptiveText picks for alphabets of up to 256
+    // symbols, index the table directly and cost one load each. Wider tokens are first mapped
+    // to a column per distinct pattern token plus one for all others through a TokenTable, which
+    // adds one or two dependent loads per token and is not counted by `fits`, so SearchEngine
+    // picks the DFA by itself only for byte texts. States are stored as row offsets, which saves
+    // the multiplication in the loop.
+    template <class T>
+    class DenseDfaMatcher {
+    public:
+        // Keeps the table within L2.
+        static constexpr size_t MAX_TABLE_BYTES = size_t{1} << 20;
+        static constexpr bool DIRECT = sizeof(T) == 1;
+
+        explicit DenseDfaMatcher(std::vector<T> const& pattern)
+            : size(pattern.size()), columns(distinctTokens(pattern), 0) {
+            if (!fits(pattern)) {
+                throw std::invalid_argument("Error: the dense DFA table of this pattern does not fit in L2");
+            }
+            size_t width = DIRECT ? size_t{1} << 8 : assignColumns(pattern);
+            stride = static_cast<uint32_t>(width);
+            table.assign((size + 1) * width, 0);
+            if (size == 0) {
+                return;
+            }
+            // Row j copies the row of the longest proper border x of the first j tokens and only
+            // overrides the transition on pattern[j].
+            table[column(pattern[0])] = stride;
+            size_t x = 0;
+            for (size_t j = 1; j <= size; ++j) {
+                std::copy_n(table.begin() + static_cast<std::ptrdiff_t>(x * width), width,
+                            table.begin() + static_cast<std::ptrdiff_t>(j * width));
+                if (j < size) {
+                    table[j * width + column(pattern[j])] = static_cast<uint32_t>((j + 1) * width);
+                    x = table[x * width + column(pattern[j])] / width;
+                }
+            }
+        }
+
+        // Whether the transition table of `pattern`, without the column map, stays within
+        // MAX_TABLE_BYTES.
+        static bool fits(std::vector<T> const& pattern) {
+            size_t width = size_t{1} << 8;
+            if constexpr (!DIRECT) {
+                width = distinctTokens(pattern) + 1;
+            }
+            return (pattern.size() + 1) * width * sizeof(uint32_t) <= MAX_TABLE_BYTES;
+        }
+
+        // Same contract as KmpAutomaton::search.
+        template <class F>
+        void search(T const* first, T const* last, T const* limit, F&& onMatch) const {
+            if (size == 0 || last <= first) {
+                return;
+            }
+            auto m = static_cast<std::ptrdiff_t>(size);
+            T const* end = limit - last < m ? limit : last + (m - 1);
+            uint32_t const accept = static_cast<uint32_t>(size) * stride;
+            uint32_t const* rows = table.data();
+            uint32_t state = 0;
+            for (T const* p = first; p != end; ++p) {
+                state = rows[state + column(*p)];
+                if (state == accept) {
+                    onMatch(static_cast<size_t>(p - first + 1 - m));
+                }
+            }
+        }
+
+    protected:
+        // Columns 1..k for the distinct pattern tokens, 0 for every other token.
+        size_t assignColumns(std::vector<T> const& pattern) {
+            uint32_t next = 1;
+            for (auto const& token : pattern) {
+                auto& c = columns.at(token);
+                if (c == 0) {
+                    c = next++;
+                }
+            }
+            return next;
+        }
+
+        uint32_t column(T token) const {
+            if constexpr (DIRECT) {
+                return static_cast<uint8_t>(token);
+            } else {
+                return columns.get(token);
+            }
+        }
+
+    protected:
+        size_t size;
+        uint32_t stride = 0;
+        TokenTable<T, uint32_t> columns;
+        std::vector<uint32_t> table;
+    };
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef HORSPOOL_HPP
+#define HORSPOOL_HPP
+
+#include <token_table.hpp>
+#include <two_way.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Boyer-Moore-Horspool: the window is compared right to left and then shifted by how far the
+    // token under its last position is from the pattern end. Over a large alphabet most tokens
+    // are absent from the pattern and shift the window by its whole length; the skip table is
+    // hashed so it costs only the distinct pattern tokens. Compared tokens are budgeted like
+    // PrefilterMatcher's verification, and a range that spends more is finished by Two-Way, so
+    // short shifts over long partial matches stay linear.
+    template <class T>
+    class HorspoolMatcher {
+    public:
+        static constexpr size_t VERIFY_BUDGET = 4;
+
+        explicit HorspoolMatcher(std::vector<T> pattern)
+            : pattern(std::move(pattern)), skip(distinctTokens(this->pattern), this->pattern.size()), fallback(this->pattern) {
+            for (size_t i = 0; i + 1 < this->pattern.size(); ++i) {
+                skip.at(this->pattern[i]) = this->pattern.size() - 1 - i;
+            }
+        }
+
+        // Same contract as KmpAutomaton::search.
+        template <class F>
+        void search(T const* first, T const* last, T const* limit, F&& onMatch) const {
+            auto m = static_cast<std::ptrdiff_t>(pattern.size());
+            if (m == 0 || limit - first < m) {
+                return;
+            }
+            auto end = static_cast<size_t>(std::min(last - first, limit - first - (m - 1)));
+            auto tail = static_cast<size_t>(m - 1);
+            T const back = pattern.back();
+            size_t budget = VERIFY_BUDGET * end + pattern.size();
+            size_t verified = 0;
+            for (size_t j = 0; j < end; j += skip.get(first[j + tail])) {
+                if (budget < verified) {
+                    fallback.search(first + j, last, limit, [&](size_t offset) {
+                        onMatch(j + offset);
+                    });
+                    return;
+                }
+                if (first[j + tail] == back) {
+                    auto mismatch = std::mismatch(pattern.begin(), pattern.end() - 1, first + j).first;
+                    verified += static_cast<size_t>(mismatch - pattern.begin()) + 1;
+                    if (mismatch == pattern.end() - 1) {
+                        onMatch(j);
+                    }
+                }
+            }
+        }
+
+    protected:
+        std::vector<T> pattern;
+        TokenTable<T, size_t> skip;
+        TwoWayMatcher<T> fallback;
+    };
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef KMP_AUTOMATON_HPP
+#define KMP_AUTOMATON_HPP
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Knuth-Morris-Pratt matcher as a state machine: the state is the length of the longest
+    // pattern prefix that ends at the current token.
+    template <class T>
+    class KmpAutomaton {
+    public:
+        explicit KmpAutomaton(std::vector<T> pattern)
+            : pattern(std::move(pattern)), failure(this->pattern.size()) {
+            for (size_t i = 1, k = 0; i < this->pattern.size(); ++i) {
+                while (k != 0 && this->pattern[i] != this->pattern[k]) {
+                    k = failure[k - 1];
+                }
+                if (this->pattern[i] == this->pattern[k]) {
+                    ++k;
+                }
+                failure[i] = k;
+            }
+        }
+
+        size_t size() const {
+            return pattern.size();
+        }
+
+        std::vector<T> const& getPattern() const {
+            return pattern;
+        }
+
+        // State after reading `token`; a full match is reported as state == size().
+        size_t step(size_t state, T token) const {
+            if (state == pattern.size()) {
+                state = failure[state - 1];
+            }
+            while (state != 0 && pattern[state] != token) {
+                state = failure[state - 1];
+            }
+            return pattern[state] == token ? state + 1 : 0;
+        }
+
+        // Calls `onMatch(offset)` for every occurrence starting in [first, last); the tokens after
+        // `last` up to `limit` are only read to complete matches that start before `last`.
+        template <class F>
+        void search(T const* first, T const* last, T const* limit, F&& onMatch) const {
+            if (pattern.empty() || last <= first) {
+                return;
+            }
+            auto m = static_cast<std::ptrdiff_t>(pattern.size());
+            T const* end = limit - last < m ? limit : last + (m - 1);
+            size_t state = 0;
+            for (T const* p = first; p != end; ++p) {
+                state = step(state, *p);
+                if (state == pattern.size()) {
+                    onMatch(static_cast<size_t>(p - first + 1 - m));
+                }
+            }
+        }
+
+    protected:
+        std::vector<T> pattern;
+        std::vector<size_t> failure;
+    };
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef LINE_CURSOR_HPP
+#define LINE_CURSOR_HPP
+
+#include <text_position.hpp>
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Maps token offsets to positions over the prefix sums of words per line. Occurrences come
+    // sorted, so the line only ever moves forward: O(matches + lines) for a whole answer.
+    template <class T>
+    class LineCursor {
+    public:
+        // `wordsTillLine[i]` is the number of tokens before line i, with one extra entry at the end.
+        explicit LineCursor(std::span<T const> wordsTillLine) : wordsTillLine(wordsTillLine) {}
+
+        // Starts at the line holding `offset`, found by binary search.
+        LineCursor(std::span<T const> wordsTillLine, size_t offset) : wordsTillLine(wordsTillLine) {
+            auto it = std::upper_bound(wordsTillLine.begin(), wordsTillLine.end(), offset, [](size_t o, T w) {
+                return o < static_cast<size_t>(w);
+            });
+            auto index = static_cast<size_t>(it - wordsTillLine.begin());
+            line = index < 2 ? 0 : std::min(index, wordsTillLine.size() - 1) - 1;
+        }
+
+        // `offset` must not be smaller than on the previous call.
+        TextPosition locate(size_t offset) {
+            while (line + 2 < wordsTillLine.size() && static_cast<size_t>(wordsTillLine[line + 1]) <= offset) {
+                ++line;
+            }
+            return {line + 1, offset - static_cast<size_t>(wordsTillLine[line]) + 1};
+        }
+
+    protected:
+        std::span<T const> wordsTillLine;
+        size_t line = 0;
+    };
+
+    template <class T>
+    LineCursor(std::vector<T> const&) -> LineCursor<T>;
+
+    template <class T>
+    LineCursor(std::vector<T> const&, size_t) -> LineCursor<T>;
+
+}
+
+#endif
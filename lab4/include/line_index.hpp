@@ -0,0 +1,188 @@
+#ifndef LINE_INDEX_HPP
+#define LINE_INDEX_HPP
+
+#include <text_position.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Line boundaries as one bitvector over tokens and line ends: every token is a 0 bit and
+    // every end of line a 1 bit, so empty lines cost one bit and the whole index about
+    // (tokens + lines) * 1.15 bits instead of two 32-bit words per line. Rank counts are kept per
+    // 512-bit superblock and every SAMPLE-th 0 and 1 remembers its superblock; all of it is
+    // appended while the text is parsed. The i-th token lies at select0(i), so its line is the
+    // number of 1 bits before that, and the line starts after the previous 1. `locate` answers
+    // random queries; sorted occurrences go through a Cursor, which walks the bitvector forward.
+    class LineIndex {
+    public:
+        static constexpr size_t SUPERBLOCK = 512;
+        static constexpr size_t SAMPLE = 4096;
+
+        // LineCursor over the bitvector: offsets come sorted, so the cursor steps from one 1 bit
+        // to the next with countr_zero and a whole answer costs O(matches + lines / 64 words).
+        // Gaps longer than a superblock are crossed by `select` instead of the walk.
+        class Cursor {
+        public:
+            // Starts at the line holding `offset`.
+            explicit Cursor(LineIndex const& index, size_t offset = 0) : index(index) {
+                if (offset < index.tokens()) {
+                    seek(offset);
+                }
+            }
+
+            // `offset` must not be smaller than on the previous call.
+            TextPosition locate(size_t offset) {
+                if (end + SUPERBLOCK < offset) {
+                    seek(offset);
+                }
+                while (end <= offset) {
+                    start = end;
+                    ++line;
+                    one = index.nextOne(one + 1);
+                    end = one - line;
+                }
+                return {line + 1, offset - start + 1};
+            }
+
+        protected:
+            void seek(size_t offset) {
+                size_t bit = index.select(false, offset);
+                line = bit - offset;
+                start = index.lineStart(line);
+                one = index.nextOne(bit);
+                end = one - line;
+            }
+
+        protected:
+            LineIndex const& index;
+            size_t line = 0;
+            // Tokens before `line` and before the next line, and the position of the 1 ending `line`.
+            size_t start = 0;
+            size_t end = 0;
+            size_t one = 0;
+        };
+
+        size_t lines() const {
+            return ones;
+        }
+
+        size_t tokens() const {
+            return size - ones;
+        }
+
+        // Appends a line of `count` tokens.
+        void addLine(size_t count) {
+            appendZeros(count);
+            appendOne();
+        }
+
+        // Tokens before `line`, counted from 0.
+        size_t lineStart(size_t line) const {
+            return line == 0 ? 0 : select(true, line - 1) + 1 - line;
+        }
+
+        TextPosition locate(size_t offset) const {
+            size_t line = select(false, offset) - offset;
+            return {line + 1, offset - lineStart(line) + 1};
+        }
+
+        // wordsTillLine as it used to be stored: lines() + 1 prefix sums starting with 0.
+        std::vector<uint32_t> prefixSums() const {
+            std::vector<uint32_t> sums;
+            sums.reserve(lines() + 1);
+            sums.push_back(0);
+            for (size_t line = 0, one = 0; line < lines(); ++line, ++one) {
+                one = nextOne(one);
+                sums.push_back(static_cast<uint32_t>(one - line));
+            }
+            return sums;
+        }
+
+    protected:
+        void appendZeros(size_t count) {
+            size_t zeros = size - ones;
+            for (size_t s = (size + SUPERBLOCK - 1) / SUPERBLOCK; s * SUPERBLOCK < size + count; ++s) {
+                superOnes.push_back(ones);
+            }
+            for (size_t j = (zeros + SAMPLE - 1) / SAMPLE; j * SAMPLE < zeros + count; ++j) {
+                zeroSamples.push_back(static_cast<uint32_t>((size + j * SAMPLE - zeros) / SUPERBLOCK));
+            }
+            size += count;
+            bits.resize((size + 63) / 64);
+        }
+
+        void appendOne() {
+            if (size % SUPERBLOCK == 0) {
+                superOnes.push_back(ones);
+            }
+            if (ones % SAMPLE == 0) {
+                oneSamples.push_back(static_cast<uint32_t>(size / SUPERBLOCK));
+            }
+            bits.resize(size / 64 + 1);
+            bits[size / 64] |= uint64_t{1} << (size % 64);
+            ++size;
+            ++ones;
+        }
+
+        // Position of the first 1 bit at or after `from`; there must be one.
+        size_t nextOne(size_t from) const {
+            size_t w = from / 64;
+            uint64_t word = bits[w] & (~uint64_t{0} << (from % 64));
+            while (word == 0) {
+                word = bits[++w];
+            }
+            return w * 64 + static_cast<size_t>(std::countr_zero(word));
+        }
+
+        // `bit` bits in the superblocks before `superblock`.
+        size_t countBefore(bool bit, size_t superblock) const {
+            return bit ? superOnes[superblock] : superblock * SUPERBLOCK - superOnes[superblock];
+        }
+
+        // Position of the k-th (from 0) `bit` bit: the samples bound the superblock, a binary
+        // search finds it, popcounts the word and a short loop the bit. That is O(log r) for the
+        // r superblocks between two samples, about (SAMPLE + the other bits among them) /
+        // SUPERBLOCK, so sorted offsets go through Cursor rather than through here.
+        size_t select(bool bit, size_t k) const {
+            auto const& samples = bit ? oneSamples : zeroSamples;
+            size_t from = samples[k / SAMPLE];
+            size_t to = k / SAMPLE + 1 < samples.size() ? samples[k / SAMPLE + 1] + size_t{1} : superOnes.size();
+            while (1 < to - from) {
+                size_t mid = from + (to - from) / 2;
+                if (countBefore(bit, mid) <= k) {
+                    from = mid;
+                } else {
+                    to = mid;
+                }
+            }
+            size_t rest = k - countBefore(bit, from);
+            for (size_t w = from * (SUPERBLOCK / 64);; ++w) {
+                uint64_t word = bit ? bits[w] : ~bits[w];
+                auto count = static_cast<size_t>(std::popcount(word));
+                if (rest < count) {
+                    for (; rest != 0; --rest) {
+                        word &= word - 1;
+                    }
+                    return w * 64 + static_cast<size_t>(std::countr_zero(word));
+                }
+                rest -= count;
+            }
+        }
+
+    protected:
+        std::vector<uint64_t> bits;
+        std::vector<size_t> superOnes;
+        std::vector<uint32_t> zeroSamples;
+        std::vector<uint32_t> oneSamples;
+        size_t size = 0;
+        size_t ones = 0;
+    };
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef PARALLEL_SEARCH_HPP
+#define PARALLEL_SEARCH_HPP
+
+#include <line_index.hpp>
+#include <text_position.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Chunks are sized in bytes, so one stays within L2 next to its matcher whatever width
+    // AdaptiveText picked for the tokens.
+    constexpr size_t CHUNK_BYTES = size_t{1} << 18;
+
+    // Occurrences per parallelLocate slice.
+    constexpr size_t LOCATE_SLICE = size_t{1} << 16;
+
+    // Runs `task(i)` for every i in [0, tasks) on `threads` workers that take the next index
+    // from a shared counter, so uneven chunks balance themselves.
+    template <class F>
+    void parallelFor(size_t threads, size_t tasks, F const& task) {
+        threads = std::clamp<size_t>(threads, 1, std::max<size_t>(tasks, 1));
+        std::atomic<size_t> next{0};
+        auto work = [&]() {
+            for (size_t i = next.fetch_add(1); i < tasks; i = next.fetch_add(1)) {
+                task(i);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; ++t) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Occurrence starts in increasing order, found by any matcher with KmpAutomaton's `search`
+    // contract. Chunk i owns the starts in [i * chunk, (i + 1) * chunk)
+    // and reads up to pattern size - 1 tokens past its end, so each match is found by exactly one
+    // chunk and the per-chunk results concatenate in order.
+    template <class Matcher, class T>
+    std::vector<size_t> parallelSearch(Matcher const& matcher, std::vector<T> const& text,
+                                       size_t threads, size_t chunk = CHUNK_BYTES / sizeof(T)) {
+        size_t chunks = (text.size() + chunk - 1) / chunk;
+        std::vector<std::vector<size_t>> found(chunks);
+        parallelFor(threads, chunks, [&](size_t i) {
+            size_t from = i * chunk;
+            size_t to = std::min(from + chunk, text.size());
+            T const* base = text.data();
+            matcher.search(base + from, base + to, base + text.size(), [&](size_t offset) {
+                found[i].push_back(from + offset);
+            });
+        });
+
+        std::vector<size_t> occurrences;
+        for (auto const& part : found) {
+            occurrences.insert(occurrences.end(), part.begin(), part.end());
+        }
+        return occurrences;
+    }
+
+    // Number of occurrences, chunked like parallelSearch but without storing them.
+    template <class Matcher, class T>
+    size_t parallelCount(Matcher const& matcher, std::vector<T> const& text, size_t threads, size_t chunk = CHUNK_BYTES / sizeof(T)) {
+        size_t chunks = (text.size() + chunk - 1) / chunk;
+        std::vector<size_t> counts(chunks);
+        parallelFor(threads, chunks, [&](size_t i) {
+            size_t from = i * chunk;
+            size_t to = std::min(from + chunk, text.size());
+            T const* base = text.data();
+            size_t count = 0;
+            matcher.search(base + from, base + to, base + text.size(), [&count](size_t) {
+                ++count;
+            });
+            counts[i] = count;
+        });
+        return std::accumulate(counts.begin(), counts.end(), size_t{0});
+    }
+
+    // Maps occurrences to positions; each slice seeks a LineIndex cursor to its first occurrence
+    // and walks forward from there.
+    inline std::vector<TextPosition> parallelLocate(std::vector<size_t> const& occurrences,
+                                                    LineIndex const& lines, size_t threads) {
+        std::vector<TextPosition> positions(occurrences.size());
+        size_t slices = (occurrences.size() + LOCATE_SLICE - 1) / LOCATE_SLICE;
+        parallelFor(threads, slices, [&](size_t i) {
+            size_t from = i * LOCATE_SLICE;
+            size_t to = std::min(from + LOCATE_SLICE, occurrences.size());
+            LineIndex::Cursor cursor(lines, occurrences[from]);
+            for (size_t j = from; j < to; ++j) {
+                positions[j] = cursor.locate(occurrences[j]);
+            }
+        });
+        return positions;
+    }
+
+}
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef PREFILTER_HPP
+#define PREFILTER_HPP
+
+#include <two_way.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define DA_LAB4_AVX2_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace da_lab4 {
+
+    // Calls `f(token)` for about `tokens` tokens of `text` taken in 16 windows spread evenly over
+    // it, so a head unlike the rest of the text does not decide alone. Returns how many it visited.
+    template <class T, class F>
+    size_t visitSample(std::vector<T> const& text, size_t tokens, F&& f) {
+        constexpr size_t WINDOWS = 16;
+        if (text.size() <= tokens) {
+            std::for_each(text.begin(), text.end(), f);
+            return text.size();
+        }
+        size_t window = std::max<size_t>(tokens / WINDOWS, 1);
+        for (size_t w = 0; w < WINDOWS; ++w) {
+            auto from = text.begin() + static_cast<std::ptrdiff_t>((text.size() - window) * w / (WINDOWS - 1));
+            std::for_each(from, from + static_cast<std::ptrdiff_t>(window), f);
+        }
+        return window * WINDOWS;
+    }
+
+#ifdef DA_LAB4_AVX2_DISPATCH
+    inline bool hasAvx2() {
+        static bool const supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+    // Checks 32 bytes of starts per iteration: tokens at offsets `a` and `b` of each start are
+    // compared against the anchors, and only starts passing both reach `verify`. The byte mask of
+    // wider lanes keeps one bit per lane. Returns where it stopped, early if `verify` says false.
+    template <class T, class F>
+    __attribute__((target("avx2")))
+    T const* anchorScanAvx2(T const* p, T const* end, size_t a, T tokenA, size_t b, T tokenB, F& verify) {
+        constexpr std::ptrdiff_t lanes = 32 / sizeof(T);
+        __m256i wantA, wantB;
+        uint32_t laneBits;
+        if constexpr (sizeof(T) == 1) {
+            wantA = _mm256_set1_epi8(static_cast<char>(tokenA));
+            wantB = _mm256_set1_epi8(static_cast<char>(tokenB));
+            laneBits = 0xffffffffu;
+        } else if constexpr (sizeof(T) == 2) {
+            wantA = _mm256_set1_epi16(static_cast<short>(tokenA));
+            wantB = _mm256_set1_epi16(static_cast<short>(tokenB));
+            laneBits = 0x55555555u;
+        } else {
+            wantA = _mm256_set1_epi32(static_cast<int>(tokenA));
+            wantB = _mm256_set1_epi32(static_cast<int>(tokenB));
+            laneBits = 0x11111111u;
+        }
+        for (; lanes <= end - p; p += lanes) {
+            auto atA = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + a));
+            auto atB = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + b));
+            __m256i both;
+            if constexpr (sizeof(T) == 1) {
+                both = _mm256_and_si256(_mm256_cmpeq_epi8(atA, wantA), _mm256_cmpeq_epi8(atB, wantB));
+            } else if constexpr (sizeof(T) == 2) {
+                both = _mm256_and_si256(_mm256_cmpeq_epi16(atA, wantA), _mm256_cmpeq_epi16(atB, wantB));
+            } else {
+                both = _mm256_and_si256(_mm256_cmpeq_epi32(atA, wantA), _mm256_cmpeq_epi32(atB, wantB));
+            }
+            auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(both)) & laneBits;
+            while (mask != 0) {
+                if (!verify(p + static_cast<unsigned>(__builtin_ctz(mask)) / sizeof(T))) {
+                    return p;
+                }
+                mask &= mask - 1;
+            }
+        }
+        return p;
+    }
+#endif
+
+    // Filter-and-verify matcher: a start is verified against the whole pattern only if two
+    // anchor tokens of the pattern are in place. Fast when anchors are rare in the text. Verified
+    // tokens are budgeted at VERIFY_BUDGET per start plus the pattern size; once a range spends
+    // more, as `0 ... 0 1` in a run of zeros does, its rest goes to Two-Way, so a bad estimate of
+    // `selective` costs a constant factor, never quadratic time.
+    template <class T>
+    class PrefilterMatcher {
+    public:
+        // Largest estimated share of starts passing the filter at which the filter still pays off.
+        static constexpr double MAX_PASS_RATE = 1.0 / 16;
+        static constexpr size_t SAMPLE_TOKENS = size_t{1} << 16;
+        static constexpr size_t VERIFY_BUDGET = 4;
+
+        explicit PrefilterMatcher(std::vector<T> pattern)
+            : pattern(std::move(pattern)), anchorB(this->pattern.empty() ? 0 : this->pattern.size() - 1),
+              fallback(this->pattern) {}
+
+        size_t size() const {
+            return pattern.size();
+        }
+
+        // Picks the two pattern positions whose tokens are rarest in a sample of `text` and tells
+        // whether the filter is expected to reject most starts.
+        bool selective(std::vector<T> const& text) {
+            if (pattern.empty()) {
+                return false;
+            }
+            std::vector<T> distinct(pattern);
+            std::sort(distinct.begin(), distinct.end());
+            distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+            std::vector<size_t> counts(distinct.size());
+            size_t sample = visitSample(text, SAMPLE_TOKENS, [&](T const& token) {
+                auto it = std::lower_bound(distinct.begin(), distinct.end(), token);
+                if (it != distinct.end() && *it == token) {
+                    ++counts[static_cast<size_t>(it - distinct.begin())];
+                }
+            });
+            auto frequency = [&](size_t position) {
+                auto it = std::lower_bound(distinct.begin(), distinct.end(), pattern[position]);
+                return counts[static_cast<size_t>(it - distinct.begin())];
+            };
+
+            std::vector<size_t> positions(pattern.size());
+            for (size_t i = 0; i < positions.size(); ++i) {
+                positions[i] = i;
+            }
+            std::stable_sort(positions.begin(), positions.end(), [&](size_t x, size_t y) {
+                return frequency(x) < frequency(y);
+            });
+            anchorA = positions[0];
+            anchorB = positions.size() == 1 ? positions[0] : positions[1];
+            if (sample == 0) {
+                return true;
+            }
+            auto n = static_cast<double>(sample);
+            double rate = static_cast<double>(frequency(anchorA)) / n;
+            if (anchorB != anchorA) {
+                rate *= static_cast<double>(frequency(anchorB)) / n;
+            }
+            return rate <= MAX_PASS_RATE;
+        }
+
+        // Same contract as KmpAutomaton::search.
+        template <class F>
+        void search(T const* first, T const* last, T const* limit, F&& onMatch) const {
+            auto m = static_cast<std::ptrdiff_t>(pattern.size());
+            if (m == 0 || limit - first < m) {
+                return;
+            }
+            T const* end = std::min(last, limit - (m - 1));
+            size_t budget = VERIFY_BUDGET * static_cast<size_t>(std::max<std::ptrdiff_t>(end - first, 0)) + pattern.size();
+            size_t verified = 0;
+            T const* handOver = nullptr;
+            auto verify = [&](T const* p) {
+                if (budget < verified) {
+                    handOver = p;
+                    return false;
+                }
+                auto mismatch = std::mismatch(pattern.begin(), pattern.end(), p).first;
+                verified += static_cast<size_t>(mismatch - pattern.begin()) + 1;
+                if (mismatch == pattern.end()) {
+                    onMatch(static_cast<size_t>(p - first));
+                }
+                return true;
+            };
+            T const* p = first;
+            T const tokenA = pattern[anchorA];
+            T const tokenB = pattern[anchorB];
+#ifdef DA_LAB4_AVX2_DISPATCH
+            if constexpr (std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> || std::is_same_v<T, uint32_t>) {
+                if (hasAvx2() && p < end) {
+                    p = anchorScanAvx2(p, end, anchorA, tokenA, anchorB, tokenB, verify);
+                }
+            }
+#endif
+            for (; p < end && handOver == nullptr; ++p) {
+                if (p[anchorA] == tokenA && p[anchorB] == tokenB) {
+                    verify(p);
+                }
+            }
+            if (handOver != nullptr) {
+                auto skipped = static_cast<size_t>(handOver - first);
+                fallback.search(handOver, last, limit, [&](size_t offset) {
+                    onMatch(skipped + offset);
+                });
+            }
+        }
+
+    protected:
+        std::vector<T> pattern;
+        size_t anchorA = 0;
+        size_t anchorB;
+        TwoWayMatcher<T> fallback;
+    };
+
+}
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef SEARCH_ENGINE_HPP
+#define SEARCH_ENGINE_HPP
+
+#include <dense_dfa.hpp>
+#include <horspool.hpp>
+#include <kmp_automaton.hpp>
+#include <prefilter.hpp>
+#include <shift_or.hpp>
+#include <two_way.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace da_lab4 {
+
+    enum class Engine {
+        AUTO,
+        KMP,
+        PREFILTER,
+        SHIFT_OR,
+        HORSPOOL,
+        TWO_WAY,
+        DFA
+    };
+
+    constexpr std::string_view ENGINE_NAMES[] = {"auto", "kmp", "prefilter", "shift-or", "horspool", "two-way", "dfa"};
+
+    inline Engine parseEngine(std::string_view name) {
+        for (size_t i = 0; i < std::size(ENGINE_NAMES); ++i) {
+            if (ENGINE_NAMES[i] == name) {
+                return static_cast<Engine>(i);
+            }
+        }
+        throw std::invalid_argument("Error: unknown engine " + std::string(name));
+    }
+
+    inline std::string_view engineName(Engine engine) {
+        return ENGINE_NAMES[static_cast<size_t>(engine)];
+    }
+
+    // One single-pattern matcher chosen from the pattern and a sample of the text, or forced by
+    // name. Every engine has the range-search contract of KmpAutomaton::search.
+    template <class T>
+    class SearchEngine {
+    public:
+        static constexpr size_t SAMPLE_TOKENS = size_t{1} << 16;
+        // Below this pattern length Horspool skips are too short to beat one-pass engines.
+        static constexpr size_t MIN_HORSPOOL_PATTERN = 16;
+
+        SearchEngine(Engine engine, std::vector<T> pattern, std::vector<T> const& text)
+            : matcher(std::in_place_type<KmpAutomaton<T>>, std::vector<T>{}) {
+            PrefilterMatcher<T> prefilter(pattern);
+            if (engine == Engine::AUTO) {
+                engine = choose(pattern, text, prefilter);
+            } else if (engine == Engine::PREFILTER) {
+                prefilter.selective(text);
+            }
+            chosen = engine;
+            switch (engine) {
+                case Engine::PREFILTER:
+                    matcher.template emplace<PrefilterMatcher<T>>(std::move(prefilter));
+                    break;
+                case Engine::SHIFT_OR:
+                    matcher.template emplace<ShiftOrMatcher<T>>(pattern);
+                    break;
+                case Engine::HORSPOOL:
+                    matcher.template emplace<HorspoolMatcher<T>>(std::move(pattern));
+                    break;
+                case Engine::DFA:
+                    matcher.template emplace<DenseDfaMatcher<T>>(pattern);
+                    break;
+                case Engine::TWO_WAY:
+                    matcher.template emplace<TwoWayMatcher<T>>(std::move(pattern));
+                    break;
+                default:
+                    matcher.template emplace<KmpAutomaton<T>>(std::move(pattern));
+                    break;
+            }
+        }
+
+        Engine engine() const {
+            return chosen;
+        }
+
+        template <class F>
+        void search(T const* first, T const* last, T const* limit, F&& onMatch) const {
+            std::visit([&](auto const& m) {
+                m.search(first, last, limit, onMatch);
+            }, matcher);
+        }
+
+        // Highly periodic patterns, whose period is at most half their length, keep skips short
+        // and anchors common, so they go straight to Shift-Or or, when longer, Two-Way. Otherwise
+        // long patterns over a wide alphabet get Horspool's long skips, rare anchors the
+        // prefilter, short patterns bit-parallel Shift-Or, longer ones over a byte-wide text a
+        // dense DFA whose table stays in L2, and the rest Two-Way. Horspool and the prefilter hand
+        // a range over to Two-Way once it costs more than linear time, so no choice is quadratic.
+        static Engine choose(std::vector<T> const& pattern, std::vector<T> const& text, PrefilterMatcher<T>& prefilter) {
+            size_t m = pattern.size();
+            if (2 * smallestPeriod(pattern) <= m) {
+                return m <= ShiftOrMatcher<T>::MAX_PATTERN ? Engine::SHIFT_OR : Engine::TWO_WAY;
+            }
+            size_t sigma = distinctInSample(text);
+            if (MIN_HORSPOOL_PATTERN <= m && 4 * m <= sigma) {
+                return Engine::HORSPOOL;
+            }
+            if (prefilter.selective(text)) {
+                return Engine::PREFILTER;
+            }
+            if (m <= ShiftOrMatcher<T>::MAX_PATTERN) {
+                return Engine::SHIFT_OR;
+            }
+            if (DenseDfaMatcher<T>::DIRECT && DenseDfaMatcher<T>::fits(pattern)) {
+                return Engine::DFA;
+            }
+            return Engine::TWO_WAY;
+        }
+
+    protected:
+        // m minus the longest proper border, from the KMP failure function.
+        static size_t smallestPeriod(std::vector<T> const& pattern) {
+            std::vector<size_t> failure(pattern.size());
+            for (size_t i = 1, k = 0; i < pattern.size(); ++i) {
+                while (k != 0 && pattern[i] != pattern[k]) {
+                    k = failure[k - 1];
+                }
+                if (pattern[i] == pattern[k]) {
+                    ++k;
+                }
+                failure[i] = k;
+            }
+            return pattern.empty() ? 0 : pattern.size() - failure.back();
+        }
+
+        static size_t distinctInSample(std::vector<T> const& text) {
+            std::vector<T> sample;
+            visitSample(text, SAMPLE_TOKENS, [&sample](T const& token) {
+                sample.push_back(token);
+            });
+            std::sort(sample.begin(), sample.end());
+            return static_cast<size_t>(std::unique(sample.begin(), sample.end()) - sample.begin());
+        }
+
+    protected:
+        std::variant<KmpAutomaton<T>, PrefilterMatcher<T>, ShiftOrMatcher<T>, HorspoolMatcher<T>, TwoWayMatcher<T>,
+                     DenseDfaMatcher<T>> matcher;
+        Engine chosen = Engine::KMP;
+    };
+
+}
+
+#endif
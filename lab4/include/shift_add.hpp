@@ -0,0 +1,82 @@
+#ifndef SHIFT_ADD_HPP
+#define SHIFT_ADD_HPP
+
+#include <token_table.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Shift-Add (Baeza-Yates-Gonnet) for occurrences with at most k substituted tokens, patterns
+    // of up to 64 tokens. Bit i of the state belongs to the alignment that started i tokens ago;
+    // its mismatch counter is kept bit-sliced over bit_width(k) words plus a sticky overflow word,
+    // so a text token costs one table lookup, a shift and a ripple-carry add of the mismatch mask.
+    template <class T>
+    class ShiftAddMatcher {
+    public:
+        static constexpr size_t MAX_PATTERN = 64;
+
+        ShiftAddMatcher(std::vector<T> const& pattern, size_t k)
+            : size(pattern.size()), maxMismatches(std::min(k, pattern.size())), planes(std::bit_width(maxMismatches)),
+              masks(distinctTokens(pattern), MAX_PATTERN <= size ? ~uint64_t{0} : (uint64_t{1} << size) - 1) {
+            if (MAX_PATTERN < size) {
+                throw std::invalid_argument("Error: mismatch search handles patterns of at most 64 tokens");
+            }
+            for (size_t i = 0; i < size; ++i) {
+                masks.at(pattern[i]) &= ~(uint64_t{1} << i);
+            }
+        }
+
+        // KmpAutomaton::search contract, but calls `onMatch(offset, mismatches)`.
+        template <class F>
+        void search(T const* first, T const* last, T const* limit, F&& onMatch) const {
+            if (size == 0 || last <= first) {
+                return;
+            }
+            auto m = static_cast<std::ptrdiff_t>(size);
+            T const* end = limit - last < m ? limit : last + (m - 1);
+            T const* firstFull = first + (m - 1);
+            uint64_t counters[MAX_COUNTER_BITS] = {};
+            uint64_t over = 0;
+            size_t const top = size - 1;
+            for (T const* p = first; p != end; ++p) {
+                uint64_t carry = masks.get(*p);
+                over <<= 1;
+                for (size_t j = 0; j < planes; ++j) {
+                    counters[j] <<= 1;
+                    uint64_t next = counters[j] & carry;
+                    counters[j] ^= carry;
+                    carry = next;
+                }
+                over |= carry;
+                if (firstFull <= p && (over >> top & 1) == 0) {
+                    size_t mismatches = 0;
+                    for (size_t j = 0; j < planes; ++j) {
+                        mismatches |= static_cast<size_t>(counters[j] >> top & 1) << j;
+                    }
+                    if (mismatches <= maxMismatches) {
+                        onMatch(static_cast<size_t>(p - first + 1 - m), mismatches);
+                    }
+                }
+            }
+        }
+
+    protected:
+        // k is capped at the pattern size, so its counters never need more.
+        static constexpr size_t MAX_COUNTER_BITS = 7;
+
+    protected:
+        size_t size;
+        size_t maxMismatches;
+        size_t planes;
+        TokenTable<T, uint64_t> masks;
+    };
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef SHIFT_OR_HPP
+#define SHIFT_OR_HPP
+
+#include <token_table.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Bit-parallel Shift-Or (Baeza-Yates-Gonnet) for patterns of up to 64 tokens: one table
+    // lookup, a shift and an or per text token, with no branches on mismatches.
+    template <class T>
+    class ShiftOrMatcher {
+    public:
+        static constexpr size_t MAX_PATTERN = 64;
+
+        explicit ShiftOrMatcher(std::vector<T> const& pattern)
+            : size(pattern.size()), masks(distinctTokens(pattern), ~uint64_t{0}) {
+            if (MAX_PATTERN < size) {
+                throw std::invalid_argument("Error: shift-or handles patterns of at most 64 tokens");
+            }
+            for (size_t i = 0; i < size; ++i) {
+                masks.at(pattern[i]) &= ~(uint64_t{1} << i);
+            }
+        }
+
+        // Same contract as KmpAutomaton::search.
+        template <class F>
+        void search(T const* first, T const* last, T const* limit, F&& onMatch) const {
+            if (size == 0 || last <= first) {
+                return;
+            }
+            auto m = static_cast<std::ptrdiff_t>(size);
+            T const* end = limit - last < m ? limit : last + (m - 1);
+            uint64_t const found = uint64_t{1} << (size - 1);
+            uint64_t state = ~uint64_t{0};
+            for (T const* p = first; p != end; ++p) {
+                state = (state << 1) | masks.get(*p);
+                if ((state & found) == 0) {
+                    onMatch(static_cast<size_t>(p - first + 1 - m));
+                }
+            }
+        }
+
+    protected:
+        size_t size;
+        TokenTable<T, uint64_t> masks;
+    };
+
+}
+
+#endif
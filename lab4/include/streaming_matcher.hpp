@@ -0,0 +1,113 @@
+#ifndef STREAMING_MATCHER_HPP
+#define STREAMING_MATCHER_HPP
+
+#include <kmp_automaton.hpp>
+#include <text_position.hpp>
+
+#include <deque>
+#include <span>
+#include <vector>
+
+namespace da_lab4 {
+
+    // KMP over a text that arrives in pieces of any size. The automaton state survives between
+    // calls, so a match may span several pieces; memory is independent of the text size.
+    template <class T>
+    class ResumableMatcher {
+    public:
+        explicit ResumableMatcher(std::vector<T> pattern) : automaton(std::move(pattern)) {}
+
+        size_t patternSize() const {
+            return automaton.size();
+        }
+
+        // Tokens fed so far.
+        size_t consumed() const {
+            return offset;
+        }
+
+        // Matches completed by `tokens`, as stream offsets of their first token. The result is
+        // valid until the next call.
+        std::vector<size_t> const& feed(std::span<T const> tokens) {
+            found.clear();
+            if (automaton.size() == 0) {
+                offset += tokens.size();
+                return found;
+            }
+            for (auto const& token : tokens) {
+                ++offset;
+                state = automaton.step(state, token);
+                if (state == automaton.size()) {
+                    found.push_back(offset - automaton.size());
+                }
+            }
+            return found;
+        }
+
+    protected:
+        KmpAutomaton<T> automaton;
+        size_t state = 0;
+        size_t offset = 0;
+        std::vector<size_t> found;
+    };
+
+    // ResumableMatcher that reports line/word positions. A line may be fed in several pieces and
+    // is closed with `endLine()`. Only the lines that can still hold the start of a future match
+    // are remembered, at most pattern size of them.
+    template <class T>
+    class LineMatcher {
+    public:
+        explicit LineMatcher(std::vector<T> pattern) : matcher(std::move(pattern)) {}
+
+        std::vector<TextPosition> const& feed(std::span<T const> tokens) {
+            if (!tokens.empty() && !lineHasTokens) {
+                lines.push_back({line, matcher.consumed()});
+                lineHasTokens = true;
+            }
+            found.clear();
+            for (auto start : matcher.feed(tokens)) {
+                found.push_back(locate(start));
+            }
+            forget();
+            return found;
+        }
+
+        void endLine() {
+            ++line;
+            lineHasTokens = false;
+        }
+
+    protected:
+        struct LineStart {
+            size_t line;
+            size_t offset;
+        };
+
+        TextPosition locate(size_t start) const {
+            auto it = lines.end();
+            do {
+                --it;
+            } while (start < it->offset);
+            return {it->line, start - it->offset + 1};
+        }
+
+        // Drops lines that end before the earliest start a future match could have.
+        void forget() {
+            size_t consumed = matcher.consumed();
+            size_t earliest = consumed < matcher.patternSize() ? 0 : consumed - matcher.patternSize() + 1;
+            while (2 <= lines.size() && lines[1].offset <= earliest) {
+                lines.pop_front();
+            }
+        }
+
+    protected:
+        ResumableMatcher<T> matcher;
+        std::deque<LineStart> lines;
+        size_t line = 1;
+        bool lineHasTokens = false;
+        std::vector<TextPosition> found;
+    };
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef SUFFIX_ARRAY_HPP
+#define SUFFIX_ARRAY_HPP
+
+#include <algorithm>
+#include <cinttypes>
+#include <stdexcept>
+#include <vector>
+
+namespace da_lab4 {
+
+    // SA-IS (Nong, Zhang, Chan): sorts the LMS substrings by induced sorting, names them,
+    // recurses on the names if they are not unique and induces the full order from the sorted LMS
+    // suffixes. Linear in the text size. `s` holds symbols in [0, upper].
+    inline std::vector<int32_t> suffixArrayIs(std::vector<int32_t> const& s, int32_t upper) {
+        auto n = static_cast<int32_t>(s.size());
+        auto at = [](auto& v, int32_t i) -> decltype(auto) {
+            return v[static_cast<size_t>(i)];
+        };
+        if (n == 0) {
+            return {};
+        }
+        if (n == 1) {
+            return {0};
+        }
+        if (n == 2) {
+            return s[0] < s[1] ? std::vector<int32_t>{0, 1} : std::vector<int32_t>{1, 0};
+        }
+
+        std::vector<int32_t> sa(static_cast<size_t>(n));
+        // S-type suffixes are smaller than the next suffix, L-type ones larger.
+        std::vector<bool> sType(static_cast<size_t>(n));
+        for (int32_t i = n - 2; i >= 0; --i) {
+            at(sType, i) = at(s, i) == at(s, i + 1) ? at(sType, i + 1) : at(s, i) < at(s, i + 1);
+        }
+
+        // Bucket heads for L-type (sumL) and S-type (sumS) suffixes of every symbol.
+        std::vector<int32_t> sumL(static_cast<size_t>(upper) + 1), sumS(static_cast<size_t>(upper) + 1);
+        for (int32_t i = 0; i < n; ++i) {
+            if (!at(sType, i)) {
+                ++at(sumS, at(s, i));
+            } else {
+                ++at(sumL, at(s, i) + 1);
+            }
+        }
+        for (int32_t c = 0; c <= upper; ++c) {
+            at(sumS, c) += at(sumL, c);
+            if (c < upper) {
+                at(sumL, c + 1) += at(sumS, c);
+            }
+        }
+
+        auto induce = [&](std::vector<int32_t> const& lms) {
+            std::fill(sa.begin(), sa.end(), -1);
+            std::vector<int32_t> bucket(sumS);
+            for (auto d : lms) {
+                if (d != n) {
+                    at(sa, at(bucket, at(s, d))++) = d;
+                }
+            }
+            bucket = sumL;
+            at(sa, at(bucket, at(s, n - 1))++) = n - 1;
+            for (int32_t i = 0; i < n; ++i) {
+                auto v = at(sa, i);
+                if (1 <= v && !at(sType, v - 1)) {
+                    at(sa, at(bucket, at(s, v - 1))++) = v - 1;
+                }
+            }
+            bucket = sumL;
+            for (int32_t i = n - 1; i >= 0; --i) {
+                auto v = at(sa, i);
+                if (1 <= v && at(sType, v - 1)) {
+                    at(sa, --at(bucket, at(s, v - 1) + 1)) = v - 1;
+                }
+            }
+        };
+
+        std::vector<int32_t> lmsIndex(static_cast<size_t>(n) + 1, -1);
+        std::vector<int32_t> lms;
+        for (int32_t i = 1; i < n; ++i) {
+            if (!at(sType, i - 1) && at(sType, i)) {
+                at(lmsIndex, i) = static_cast<int32_t>(lms.size());
+                lms.push_back(i);
+            }
+        }
+        auto m = static_cast<int32_t>(lms.size());
+        induce(lms);
+        if (m == 0) {
+            return sa;
+        }
+
+        std::vector<int32_t> sortedLms;
+        sortedLms.reserve(lms.size());
+        for (auto v : sa) {
+            if (at(lmsIndex, v) != -1) {
+                sortedLms.push_back(v);
+            }
+        }
+        // Equal LMS substrings get equal names; the names form the reduced problem.
+        std::vector<int32_t> reduced(lms.size());
+        int32_t names = 0;
+        at(reduced, at(lmsIndex, sortedLms[0])) = 0;
+        for (int32_t i = 1; i < m; ++i) {
+            auto l = at(sortedLms, i - 1), r = at(sortedLms, i);
+            auto endL = at(lmsIndex, l) + 1 < m ? at(lms, at(lmsIndex, l) + 1) : n;
+            auto endR = at(lmsIndex, r) + 1 < m ? at(lms, at(lmsIndex, r) + 1) : n;
+            bool same = endL - l == endR - r;
+            if (same) {
+                while (l < endL && at(s, l) == at(s, r)) {
+                    ++l;
+                    ++r;
+                }
+                same = l != n && r != n && at(s, l) == at(s, r);
+            }
+            if (!same) {
+                ++names;
+            }
+            at(reduced, at(lmsIndex, at(sortedLms, i))) = names;
+        }
+        auto reducedSa = suffixArrayIs(reduced, names);
+        for (int32_t i = 0; i < m; ++i) {
+            at(sortedLms, i) = at(lms, at(reducedSa, i));
+        }
+        induce(sortedLms);
+        return sa;
+    }
+
+    // Suffix array of an arbitrary 32-bit token text: tokens are replaced by their ranks first.
+    inline std::vector<int32_t> buildSuffixArray(std::vector<uint32_t> const& text) {
+        if (INT32_MAX <= text.size()) {
+            throw std::length_error("Error: the index supports texts of less than 2^31 tokens");
+        }
+        std::vector<uint32_t> alphabet(text);
+        std::sort(alphabet.begin(), alphabet.end());
+        alphabet.erase(std::unique(alphabet.begin(), alphabet.end()), alphabet.end());
+        std::vector<int32_t> ranks(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            ranks[i] = static_cast<int32_t>(std::lower_bound(alphabet.begin(), alphabet.end(), text[i]) - alphabet.begin());
+        }
+        return suffixArrayIs(ranks, std::max<int32_t>(static_cast<int32_t>(alphabet.size()) - 1, 0));
+    }
+
+}
+
+#endif
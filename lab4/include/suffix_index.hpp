@@ -0,0 +1,166 @@
+#ifndef SUFFIX_INDEX_HPP
+#define SUFFIX_INDEX_HPP
+
+#include <suffix_array.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Text, suffix array and line prefix sums in one file that is mapped as is, so a query costs
+    // no parsing or construction. Layout, every section padded to 8 bytes:
+    //   magic, token count, line count (uint64)
+    //   tokens (uint32 x tokens), suffix array (int32 x tokens), wordsTillLine (uint32 x lines + 1)
+    class SuffixIndex {
+    public:
+        static constexpr uint64_t MAGIC = 0x3130584449344144ull; // "DA4IDX01"
+
+        static void build(std::vector<uint32_t> const& text, std::vector<uint32_t> const& wordsTillLine,
+                          std::string const& path) {
+            auto suffixes = buildSuffixArray(text);
+            std::FILE* file = std::fopen(path.c_str(), "wb");
+            if (file == nullptr) {
+                throw std::runtime_error("Error: can't create index " + path);
+            }
+            uint64_t header[] = {MAGIC, text.size(), wordsTillLine.size() - 1};
+            bool ok = write(file, header, 3)
+                && write(file, text.data(), text.size())
+                && write(file, suffixes.data(), suffixes.size())
+                && write(file, wordsTillLine.data(), wordsTillLine.size());
+            if (std::fclose(file) != 0 || !ok) {
+                throw std::runtime_error("Error: can't write index " + path);
+            }
+        }
+
+        explicit SuffixIndex(std::string const& path) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd == -1) {
+                throw std::runtime_error("Error: can't open index " + path);
+            }
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && sizeof(uint64_t) * 3 <= static_cast<size_t>(st.st_size)) {
+                bytes = static_cast<size_t>(st.st_size);
+                void* mapped = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+                data = mapped == MAP_FAILED ? nullptr : static_cast<char const*>(mapped);
+            }
+            ::close(fd);
+            if (data == nullptr || !attach()) {
+                release();
+                throw std::runtime_error("Error: " + path + " is not a lab4 index");
+            }
+        }
+
+        SuffixIndex(SuffixIndex const&) = delete;
+        SuffixIndex& operator=(SuffixIndex const&) = delete;
+
+        ~SuffixIndex() {
+            release();
+        }
+
+        std::span<uint32_t const> text() const {
+            return tokens;
+        }
+
+        std::span<uint32_t const> wordsTillLine() const {
+            return lines;
+        }
+
+        // Starts of all occurrences in increasing order: two binary searches over the suffix array
+        // (O(m log n)) plus sorting the matching range.
+        std::vector<size_t> find(std::vector<uint32_t> const& pattern) const {
+            if (pattern.empty()) {
+                return {};
+            }
+            auto first = std::partition_point(suffixes.begin(), suffixes.end(), [&](int32_t s) {
+                return compare(s, pattern) < 0;
+            });
+            auto last = std::partition_point(first, suffixes.end(), [&](int32_t s) {
+                return compare(s, pattern) == 0;
+            });
+            std::vector<size_t> starts;
+            starts.reserve(static_cast<size_t>(last - first));
+            for (auto it = first; it != last; ++it) {
+                starts.push_back(static_cast<size_t>(*it));
+            }
+            std::sort(starts.begin(), starts.end());
+            return starts;
+        }
+
+    protected:
+        template <class T>
+        static bool write(std::FILE* file, T const* values, size_t count) {
+            static constexpr char padding[8] = {};
+            size_t size = sizeof(T) * count;
+            return std::fwrite(values, sizeof(T), count, file) == count
+                && std::fwrite(padding, 1, (8 - size % 8) % 8, file) == (8 - size % 8) % 8;
+        }
+
+        static size_t padded(size_t size) {
+            return (size + 7) / 8 * 8;
+        }
+
+        // Points the sections into the mapping after checking the header against the file size.
+        bool attach() {
+            uint64_t header[3];
+            std::copy(data, data + sizeof(header), reinterpret_cast<char*>(header));
+            if (header[0] != MAGIC || INT32_MAX <= header[1] || UINT32_MAX <= header[2]) {
+                return false;
+            }
+            size_t n = header[1];
+            size_t offset = sizeof(header);
+            size_t textOffset = offset;
+            offset += padded(sizeof(uint32_t) * n);
+            size_t suffixesOffset = offset;
+            offset += padded(sizeof(int32_t) * n);
+            size_t linesOffset = offset;
+            offset += padded(sizeof(uint32_t) * (header[2] + 1));
+            if (offset != bytes) {
+                return false;
+            }
+            tokens = {reinterpret_cast<uint32_t const*>(data + textOffset), n};
+            suffixes = {reinterpret_cast<int32_t const*>(data + suffixesOffset), n};
+            lines = {reinterpret_cast<uint32_t const*>(data + linesOffset), header[2] + 1};
+            return true;
+        }
+
+        // Compares the suffix at `start`, cut to the pattern length, with the pattern.
+        int compare(int32_t start, std::vector<uint32_t> const& pattern) const {
+            auto suffix = tokens.subspan(static_cast<size_t>(start));
+            size_t common = std::min(suffix.size(), pattern.size());
+            for (size_t i = 0; i < common; ++i) {
+                if (suffix[i] != pattern[i]) {
+                    return suffix[i] < pattern[i] ? -1 : 1;
+                }
+            }
+            return suffix.size() < pattern.size() ? -1 : 0;
+        }
+
+        void release() {
+            if (data != nullptr) {
+                ::munmap(const_cast<char*>(data), bytes);
+                data = nullptr;
+            }
+        }
+
+    protected:
+        char const* data = nullptr;
+        size_t bytes = 0;
+        std::span<uint32_t const> tokens;
+        std::span<int32_t const> suffixes;
+        std::span<uint32_t const> lines;
+    };
+
+}
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef TEXT_GENERATOR_HPP
+#define TEXT_GENERATOR_HPP
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace da_lab4 {
+
+    enum class PatternShape {
+        RANDOM,
+        PERIODIC,
+        WORST
+    };
+
+    inline PatternShape parsePatternShape(std::string_view name) {
+        if (name == "random") {
+            return PatternShape::RANDOM;
+        }
+        if (name == "periodic") {
+            return PatternShape::PERIODIC;
+        }
+        if (name == "worst") {
+            return PatternShape::WORST;
+        }
+        throw std::invalid_argument("Error: unknown pattern shape " + std::string(name));
+    }
+
+    struct GeneratorConfig {
+        uint64_t seed = 1;
+        uint64_t tokens = 1000000;
+        // Filler tokens are uniform in [0, alphabet).
+        uint32_t alphabet = 1000;
+        size_t patternSize = 16;
+        PatternShape shape = PatternShape::RANDOM;
+        // Length of the block a PERIODIC pattern repeats.
+        size_t period = 4;
+        // Planted occurrences per text token.
+        double rate = 0.001;
+        size_t minLine = 1;
+        size_t maxLine = 100;
+    };
+
+    // Parses one of --seed=, --tokens=, --alphabet=, --pattern=, --shape=, --period=, --rate=,
+    // --line=MIN/MAX into `config`; false if `arg` is none of them.
+    inline bool parseGeneratorOption(std::string_view arg, GeneratorConfig& config) {
+        auto number = [&arg](std::string_view prefix, auto& value) {
+            if (!arg.starts_with(prefix)) {
+                return false;
+            }
+            value = static_cast<std::remove_reference_t<decltype(value)>>(std::strtoull(arg.data() + prefix.size(), nullptr, 10));
+            return true;
+        };
+        if (number("--seed=", config.seed) || number("--tokens=", config.tokens) || number("--alphabet=", config.alphabet)
+            || number("--pattern=", config.patternSize) || number("--period=", config.period)) {
+            return true;
+        }
+        if (arg.starts_with("--shape=")) {
+            config.shape = parsePatternShape(arg.substr(8));
+        } else if (arg.starts_with("--rate=")) {
+            config.rate = std::strtod(arg.data() + 7, nullptr);
+        } else if (arg.starts_with("--line=")) {
+            char* end = nullptr;
+            config.minLine = std::strtoull(arg.data() + 7, &end, 10);
+            config.maxLine = *end == '/' ? std::strtoull(end + 1, nullptr, 10) : config.minLine;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Deterministic pattern and text for tests and benchmarks. The text is produced token by
+    // token, so sizes are bounded by the consumer, not by the generator. Occurrences are planted
+    // after geometric gaps of filler and may span lines; filler may hold more by chance when the
+    // alphabet is small. WORST patterns are `0 0 ... 0 1`: with alphabet 1 the text is all zeros
+    // and every position is a near miss.
+    class TextGenerator {
+    public:
+        explicit TextGenerator(GeneratorConfig const& config) : config(config), rng(config.seed) {
+            if (config.patternSize == 0 || config.alphabet == 0 || config.minLine == 0
+                || config.maxLine < config.minLine || config.rate < 0 || 1 < config.rate) {
+                throw std::invalid_argument("Error: bad generator parameters");
+            }
+            std::uniform_int_distribution<uint32_t> token(0, config.alphabet - 1);
+            size_t period = config.shape == PatternShape::PERIODIC ? std::max<size_t>(config.period, 1) : config.patternSize;
+            for (size_t i = 0; i < config.patternSize; ++i) {
+                if (config.shape == PatternShape::WORST) {
+                    pattern.push_back(i + 1 == config.patternSize ? 1 : 0);
+                } else {
+                    pattern.push_back(i < period ? token(rng) : pattern[i - period]);
+                }
+            }
+        }
+
+        std::vector<uint32_t> const& getPattern() const {
+            return pattern;
+        }
+
+        // Calls `onToken(uint32_t)` for every text token and `onLine()` after every line.
+        template <class OnToken, class OnLine>
+        void generate(OnToken&& onToken, OnLine&& onLine) {
+            std::uniform_int_distribution<uint32_t> token(0, config.alphabet - 1);
+            std::uniform_int_distribution<size_t> lineLength(config.minLine, config.maxLine);
+            std::geometric_distribution<uint64_t> gap(config.rate == 0 ? 1 : config.rate);
+            uint64_t nextOccurrence = config.rate == 0 ? UINT64_MAX : gap(rng);
+            size_t planted = pattern.size();
+            size_t lineLeft = lineLength(rng);
+            for (uint64_t i = 0; i < config.tokens; ++i) {
+                if (planted == pattern.size() && nextOccurrence == 0) {
+                    planted = 0;
+                    nextOccurrence = gap(rng);
+                }
+                if (planted < pattern.size()) {
+                    onToken(pattern[planted++]);
+                } else {
+                    onToken(token(rng));
+                    --nextOccurrence;
+                }
+                if (--lineLeft == 0 || i + 1 == config.tokens) {
+                    onLine();
+                    lineLeft = lineLength(rng);
+                }
+            }
+        }
+
+    protected:
+        GeneratorConfig config;
+        std::mt19937_64 rng;
+        std::vector<uint32_t> pattern;
+    };
+
+}
+
+#endif
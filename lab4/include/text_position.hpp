@@ -0,0 +1,16 @@
+#ifndef TEXT_POSITION_HPP
+#define TEXT_POSITION_HPP
+
+#include <cstddef>
+
+namespace da_lab4 {
+
+    // 1-based line and word of a token, as printed in the answer.
+    struct TextPosition {
+        size_t line;
+        size_t word;
+    };
+
+}
+
+#endif
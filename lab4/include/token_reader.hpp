@@ -0,0 +1,179 @@
+#ifndef TOKEN_READER_HPP
+#define TOKEN_READER_HPP
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Block-buffered parser of unsigned decimal tokens. Every byte that is not a digit separates
+    // tokens and '\n' ends a line, both recognized in the same pass over the buffer; no per-line
+    // strings or streams are created. A regular file is mapped instead of read: tokens are parsed
+    // straight out of the page cache through a window that moves like a refilled block, and the
+    // kernel is asked to fetch the next window while the current one is parsed and searched.
+    // Windows already parsed are dropped from the mapping, so resident memory stays at about
+    // two windows whatever the file size, as with a pipe.
+    class TokenReader {
+    public:
+        static constexpr size_t BLOCK_SIZE = 1 << 16;
+        static constexpr size_t MAP_WINDOW = size_t{1} << 22;
+
+        explicit TokenReader(std::FILE* file, size_t blockSize = BLOCK_SIZE)
+            : fd(fileno(file)), buffer(blockSize), data(buffer.data()) {
+            map();
+        }
+
+        TokenReader(TokenReader const&) = delete;
+        TokenReader& operator=(TokenReader const&) = delete;
+
+        ~TokenReader() {
+            if (mapped != nullptr) {
+                ::munmap(mapped, mappedSize);
+            }
+        }
+
+        // Runs before the reader may block for more input, e.g. to hand out pending answers.
+        void setBeforeRefill(std::function<void()> hook) {
+            beforeRefill = std::move(hook);
+        }
+
+        // Makes readLine return false from the next token on without reading further, even in the
+        // middle of a line, e.g. once a callback has seen all the tokens it needs.
+        void stop() {
+            stopped = true;
+        }
+
+        // Calls `onToken(uint64_t)` for every token of the next line. False once the input is
+        // exhausted or the reader stopped; a last line without '\n' still counts, like with
+        // std::getline.
+        template <class F>
+        bool readLine(F&& onToken) {
+            if (stopped || !ensure()) {
+                return false;
+            }
+            uint64_t value = 0;
+            bool inToken = false;
+            do {
+                char const* p = data + pos;
+                char const* e = data + end;
+                while (p != e) {
+                    auto digit = static_cast<unsigned>(static_cast<unsigned char>(*p) - '0');
+                    if (digit < 10) {
+                        value = value * 10 + digit;
+                        inToken = true;
+                        ++p;
+                        continue;
+                    }
+                    if (inToken) {
+                        onToken(value);
+                        if (stopped) {
+                            return false;
+                        }
+                        value = 0;
+                        inToken = false;
+                    }
+                    if (*p++ == '\n') {
+                        pos = static_cast<size_t>(p - data);
+                        return true;
+                    }
+                }
+                pos = end;
+            } while (ensure());
+            if (stopped) {
+                return false;
+            }
+            if (inToken) {
+                onToken(value);
+            }
+            return true;
+        }
+
+        // Appends the tokens of the next line to `out`.
+        template <class T>
+        bool readLine(std::vector<T>& out) {
+            return readLine([&out](uint64_t value) {
+                out.push_back(static_cast<T>(value));
+            });
+        }
+
+    protected:
+        // Maps `fd` from its current offset on if it is a non-empty regular file.
+        void map() {
+            struct stat st;
+            off_t offset = ::lseek(fd, 0, SEEK_CUR);
+            if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || offset < 0 || st.st_size <= offset) {
+                return;
+            }
+            void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                return;
+            }
+            ::madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+            mapped = p;
+            mappedSize = static_cast<size_t>(st.st_size);
+            page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            data = static_cast<char const*>(p);
+            pos = end = static_cast<size_t>(offset);
+        }
+
+        // A mapped file releases the pages parsed so far and moves its window on, hinting the one
+        // after it; anything else is read with read(2), which returns what a pipe has instead of
+        // waiting for a whole block like fread.
+        bool ensure() {
+            if (pos < end) {
+                return true;
+            }
+            if (beforeRefill) {
+                beforeRefill();
+            }
+            if (stopped) {
+                return false;
+            }
+            if (mapped != nullptr) {
+                size_t parsed = pos / page * page;
+                if (released < parsed) {
+                    ::madvise(static_cast<char*>(mapped) + released, parsed - released, MADV_DONTNEED);
+                    released = parsed;
+                }
+                end = std::min(end + MAP_WINDOW, mappedSize);
+                if (end < mappedSize) {
+                    size_t ahead = end / page * page;
+                    ::madvise(static_cast<char*>(mapped) + ahead, std::min(MAP_WINDOW, mappedSize - ahead), MADV_WILLNEED);
+                }
+                return pos < end;
+            }
+            pos = 0;
+            ssize_t got;
+            do {
+                got = ::read(fd, buffer.data(), buffer.size());
+            } while (got < 0 && errno == EINTR);
+            end = got < 0 ? 0 : static_cast<size_t>(got);
+            return end != 0;
+        }
+
+    protected:
+        int fd;
+        std::vector<char> buffer;
+        char const* data;
+        void* mapped = nullptr;
+        size_t mappedSize = 0;
+        size_t page = 0;
+        // Mapped bytes before this offset have been handed back with MADV_DONTNEED.
+        size_t released = 0;
+        std::function<void()> beforeRefill;
+        bool stopped = false;
+        size_t pos = 0;
+        size_t end = 0;
+    };
+
+}
+
+#endif
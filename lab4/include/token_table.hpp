@@ -0,0 +1,112 @@
+#ifndef TOKEN_TABLE_HPP
+#define TOKEN_TABLE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Number of distinct tokens in `pattern`, the size TokenTable wants.
+    template <class T>
+    size_t distinctTokens(std::vector<T> pattern) {
+        std::sort(pattern.begin(), pattern.end());
+        return static_cast<size_t>(std::unique(pattern.begin(), pattern.end()) - pattern.begin());
+    }
+
+    // Per-token value with a default for tokens never set, as needed by skip and mask tables.
+    // Byte tokens index a direct array of values, at most 2 KiB. A direct array of 16-bit tokens
+    // would be 256-512 KiB, beyond L1 and refilled for every matcher, so with fewer than 256
+    // distinct tokens they index a 64 KiB array of byte slots into a short value array instead:
+    // two dependent loads, of lines the text alphabet keeps hot. Everything else goes to an
+    // open-addressing table sized for the distinct tokens a pattern has.
+    template <class T, class V>
+    class TokenTable {
+    public:
+        static constexpr bool DIRECT = sizeof(T) == 1;
+        static constexpr size_t MAX_SLOTTED = 255;
+
+        TokenTable(size_t distinct, V fallback) : fallback(fallback) {
+            if constexpr (DIRECT) {
+                values.assign(size_t{1} << (8 * sizeof(T)), fallback);
+            } else if (sizeof(T) == 2 && distinct <= MAX_SLOTTED) {
+                slots.assign(size_t{1} << (8 * sizeof(T)), 0);
+                values.assign(1, fallback);
+                values.reserve(distinct + 1);
+            } else {
+                size_t capacity = std::bit_ceil(2 * distinct + 2);
+                mask = capacity - 1;
+                shift = 64 - static_cast<unsigned>(std::countr_zero(capacity));
+                keys.resize(capacity);
+                used.resize(capacity);
+                values.resize(capacity);
+            }
+        }
+
+        V get(T token) const {
+            if constexpr (DIRECT) {
+                return values[index(token)];
+            } else if (!slots.empty()) {
+                return values[slots[index(token)]];
+            } else {
+                for (size_t i = slot(token); used[i]; i = (i + 1) & mask) {
+                    if (keys[i] == token) {
+                        return values[i];
+                    }
+                }
+                return fallback;
+            }
+        }
+
+        V& at(T token) {
+            if constexpr (DIRECT) {
+                return values[index(token)];
+            } else if (!slots.empty()) {
+                auto& slot = slots[index(token)];
+                if (slot == 0) {
+                    slot = static_cast<uint8_t>(values.size());
+                    values.push_back(fallback);
+                }
+                return values[slot];
+            } else {
+                size_t i = slot(token);
+                for (; used[i]; i = (i + 1) & mask) {
+                    if (keys[i] == token) {
+                        return values[i];
+                    }
+                }
+                used[i] = 1;
+                keys[i] = token;
+                values[i] = fallback;
+                return values[i];
+            }
+        }
+
+    protected:
+        static size_t index(T token) {
+            return static_cast<size_t>(static_cast<std::make_unsigned_t<T>>(token));
+        }
+
+        // Fibonacci hashing: the top log2(capacity) bits of the product are the best mixed, so
+        // they pick the slot.
+        size_t slot(T token) const {
+            return static_cast<size_t>((uint64_t{index(token)} * 0x9e3779b97f4a7c15ull) >> shift);
+        }
+
+    protected:
+        V fallback;
+        size_t mask = 0;
+        unsigned shift = 63;
+        std::vector<T> keys;
+        std::vector<uint8_t> used;
+        // Slot of each 16-bit token in `values`, 0 for the fallback.
+        std::vector<uint8_t> slots;
+        std::vector<V> values;
+    };
+
+}
+
+#endif
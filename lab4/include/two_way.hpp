@@ -0,0 +1,110 @@
+#ifndef TWO_WAY_HPP
+#define TWO_WAY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace da_lab4 {
+
+    // Crochemore-Perrin Two-Way matching: the pattern is split at a critical factorization,
+    // the right part is matched left to right and the left part right to left. Linear time in
+    // the worst case with O(1) extra space, whatever the pattern periodicity.
+    template <class T>
+    class TwoWayMatcher {
+    public:
+        explicit TwoWayMatcher(std::vector<T> pattern) : pattern(std::move(pattern)) {
+            auto m = static_cast<std::ptrdiff_t>(this->pattern.size());
+            if (m == 0) {
+                return;
+            }
+            std::ptrdiff_t p, q;
+            auto i = maximalSuffix(false, p);
+            auto j = maximalSuffix(true, q);
+            if (i > j) {
+                split = i;
+                period = p;
+            } else {
+                split = j;
+                period = q;
+            }
+            periodic = split + 1 + period <= m
+                && std::equal(this->pattern.begin(), this->pattern.begin() + split + 1, this->pattern.begin() + period);
+            if (!periodic) {
+                period = std::max(split + 1, m - split - 1) + 1;
+            }
+        }
+
+        // Same contract as KmpAutomaton::search.
+        template <class F>
+        void search(T const* first, T const* last, T const* limit, F&& onMatch) const {
+            auto m = static_cast<std::ptrdiff_t>(pattern.size());
+            if (m == 0 || limit - first < m) {
+                return;
+            }
+            auto const* x = pattern.data();
+            auto end = std::min(last - first, limit - first - m + 1);
+            // Prefix of the window known to match from the previous shift (periodic case only).
+            std::ptrdiff_t memory = -1;
+            for (std::ptrdiff_t j = 0; j < end;) {
+                T const* y = first + j;
+                auto i = std::max(split, memory) + 1;
+                while (i < m && x[i] == y[i]) {
+                    ++i;
+                }
+                if (i < m) {
+                    j += i - split;
+                    memory = -1;
+                    continue;
+                }
+                i = split;
+                while (i > memory && x[i] == y[i]) {
+                    --i;
+                }
+                if (i <= memory) {
+                    onMatch(static_cast<size_t>(j));
+                }
+                j += period;
+                memory = periodic ? m - period - 1 : -1;
+            }
+        }
+
+    protected:
+        // Start - 1 of the maximal suffix for the token order (or its reverse) and its period.
+        std::ptrdiff_t maximalSuffix(bool reversed, std::ptrdiff_t& p) const {
+            auto m = static_cast<std::ptrdiff_t>(pattern.size());
+            std::ptrdiff_t ms = -1, j = 0, k = 1;
+            p = 1;
+            while (j + k < m) {
+                T const& a = pattern[static_cast<size_t>(j + k)];
+                T const& b = pattern[static_cast<size_t>(ms + k)];
+                if (reversed ? b < a : a < b) {
+                    j += k;
+                    k = 1;
+                    p = j - ms;
+                } else if (a == b) {
+                    if (k != p) {
+                        ++k;
+                    } else {
+                        j += p;
+                        k = 1;
+                    }
+                } else {
+                    ms = j;
+                    j = ms + 1;
+                    k = p = 1;
+                }
+            }
+            return ms;
+        }
+
+    protected:
+        std::vector<T> pattern;
+        std::ptrdiff_t split = -1;
+        std::ptrdiff_t period = 1;
+        bool periodic = false;
+    };
+
+}
+
+#endif
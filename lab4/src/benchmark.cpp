@@ -0,0 +1,385 @@
+#include <adaptive_text.hpp>
+#include <aho_corasick.hpp>
+#include <line_cursor.hpp>
+#include <line_index.hpp>
+#include <parallel_search.hpp>
+#include <search_engine.hpp>
+#include <shift_add.hpp>
+#include <streaming_matcher.hpp>
+#include <suffix_index.hpp>
+#include <text_generator.hpp>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace da_lab4;
+
+struct BenchConfig {
+    size_t warmup = 1;
+    size_t repetitions = 3;
+    std::string_view engine = "all";
+    std::string_view mode = "all";
+    size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    bool matrix = true;
+    // Matches wanted by the `first` mode, substitutions allowed by `mismatches`, and patterns
+    // searched at once by `patterns` and queried one by one by `index`.
+    size_t first = 10;
+    size_t mismatches = 1;
+    size_t patternSet = 16;
+    std::string indexPath = (std::filesystem::temp_directory_path()
+                             / ("da_lab4_bench_" + std::to_string(::getpid()) + ".idx")).string();
+};
+
+volatile uint64_t benchSink;
+
+// Median of `repetitions` timed runs after `warmup` untimed ones; `run()` returns the matches.
+template <class Run>
+double medianSeconds(BenchConfig const& config, Run&& run, uint64_t& matches) {
+    using clock = std::chrono::steady_clock;
+    for (size_t i = 0; i < config.warmup; ++i) {
+        benchSink = run();
+    }
+    std::vector<double> seconds;
+    for (size_t i = 0; i < config.repetitions; ++i) {
+        auto start = clock::now();
+        matches = run();
+        seconds.push_back(std::chrono::duration<double>(clock::now() - start).count());
+    }
+    std::sort(seconds.begin(), seconds.end());
+    return seconds[seconds.size() / 2];
+}
+
+void report(std::string_view engine, std::string_view chosen, std::string_view mode, size_t tokens,
+            uint64_t matches, double seconds, bool& first) {
+    std::cout << (first ? "" : ",\n") << "      {\"engine\": \"" << engine << "\", ";
+    if (!chosen.empty()) {
+        std::cout << "\"chosen\": \"" << chosen << "\", ";
+    }
+    std::cout << "\"mode\": \"" << mode << "\", \"matches\": " << matches
+              << ", \"tokens_per_s\": " << static_cast<uint64_t>(static_cast<double>(tokens) / seconds)
+              << ", \"matches_per_s\": " << static_cast<uint64_t>(static_cast<double>(matches) / seconds) << "}";
+    first = false;
+}
+
+bool selected(std::string_view wanted, std::string_view name) {
+    return wanted == "all" || wanted == name;
+}
+
+// The workload pattern followed by `count - 1` pattern-sized pieces of the text taken at even
+// steps, so every pattern of the set occurs at least once.
+template <class T>
+std::vector<std::vector<T>> patternSet(std::vector<T> const& pattern, std::vector<T> const& text, size_t count) {
+    std::vector<std::vector<T>> patterns = {pattern};
+    if (text.size() < pattern.size()) {
+        return patterns;
+    }
+    size_t step = (text.size() - pattern.size()) / std::max<size_t>(count, 1) + 1;
+    for (size_t i = 1; i < count; ++i) {
+        auto from = text.begin() + static_cast<std::ptrdiff_t>(i * step % (text.size() - pattern.size() + 1));
+        patterns.emplace_back(from, from + static_cast<std::ptrdiff_t>(pattern.size()));
+    }
+    return patterns;
+}
+
+// Matches of the line by line LineMatcher feed, stopping after the line where `limit` are found;
+// `scanned` is set to the tokens fed till then.
+template <class T>
+uint64_t streamSearch(std::vector<T> const& pattern, std::vector<T> const& text, LineIndex const& lines,
+                      uint64_t limit, size_t& scanned) {
+    LineMatcher<T> matcher(pattern);
+    uint64_t found = 0;
+    size_t start = 0;
+    for (size_t line = 0; line < lines.lines() && found < limit; ++line) {
+        size_t next = line + 1 < lines.lines() ? lines.lineStart(line + 1) : lines.tokens();
+        found += matcher.feed(std::span<T const>(text.data() + start, text.data() + next)).size();
+        matcher.endLine();
+        start = next;
+    }
+    scanned = start;
+    return std::min(found, limit);
+}
+
+// The modes of lab4's exec that don't go through SearchEngine: `first` and `exists` stop the
+// line by line feed at the first `config.first` matches or the first one and count only the
+// tokens read till then, `mismatches` runs Shift-Add, `patterns` runs Aho-Corasick over the
+// pattern set, `build-index` writes the suffix index and `index` answers the pattern set from it,
+// one query after another; tokens/s of the last two are text tokens indexed or searched.
+template <class T>
+void benchOtherModes(std::vector<T> const& pattern, std::vector<T> const& text, LineIndex const& lines,
+                     BenchConfig const& config, bool& first) {
+    uint64_t matches = 0;
+    size_t scanned = 0;
+    if (selected(config.engine, "kmp") && selected(config.mode, "first")) {
+        auto seconds = medianSeconds(config, [&]() {
+            return streamSearch(pattern, text, lines, config.first, scanned);
+        }, matches);
+        report("kmp", "", "first", scanned, matches, seconds, first);
+    }
+    if (selected(config.engine, "kmp") && selected(config.mode, "exists")) {
+        auto seconds = medianSeconds(config, [&]() {
+            return streamSearch(pattern, text, lines, 1, scanned);
+        }, matches);
+        report("kmp", "", "exists", scanned, matches, seconds, first);
+    }
+    if (selected(config.engine, "shift-add") && selected(config.mode, "mismatches")
+        && pattern.size() <= ShiftAddMatcher<T>::MAX_PATTERN) {
+        ShiftAddMatcher<T> matcher(pattern, config.mismatches);
+        auto end = text.data() + text.size();
+        auto seconds = medianSeconds(config, [&]() {
+            uint64_t found = 0, sink = 0;
+            LineIndex::Cursor cursor(lines);
+            matcher.search(text.data(), end, end, [&](size_t offset, size_t mismatches) {
+                sink += cursor.locate(offset).word + mismatches;
+                ++found;
+            });
+            benchSink = sink;
+            return found;
+        }, matches);
+        report("shift-add", "", "mismatches", text.size(), matches, seconds, first);
+    }
+
+    bool patterns = selected(config.engine, "aho-corasick") && selected(config.mode, "patterns");
+    bool index = selected(config.engine, "suffix-index")
+        && (selected(config.mode, "build-index") || selected(config.mode, "index"));
+    if (!patterns && !index) {
+        return;
+    }
+    auto queries = patternSet(pattern, text, config.patternSet);
+    if (patterns) {
+        AhoCorasick<T> automaton(queries);
+        auto seconds = medianSeconds(config, [&]() {
+            std::vector<std::pair<size_t, size_t>> occurrences;
+            automaton.search(text, [&occurrences](size_t id, size_t start) {
+                occurrences.emplace_back(start, id);
+            });
+            std::sort(occurrences.begin(), occurrences.end());
+            uint64_t sink = 0;
+            LineIndex::Cursor cursor(lines);
+            for (auto const& [start, id] : occurrences) {
+                sink += cursor.locate(start).word + id;
+            }
+            benchSink = sink;
+            return static_cast<uint64_t>(occurrences.size());
+        }, matches);
+        report("aho-corasick", "", "patterns", text.size(), matches, seconds, first);
+    }
+    if (index) {
+        std::vector<uint32_t> wide(text.begin(), text.end());
+        auto sums = lines.prefixSums();
+        auto seconds = medianSeconds(config, [&]() {
+            SuffixIndex::build(wide, sums, config.indexPath);
+            return uint64_t{0};
+        }, matches);
+        if (selected(config.mode, "build-index")) {
+            report("suffix-index", "", "build-index", text.size(), matches, seconds, first);
+        }
+        if (selected(config.mode, "index")) {
+            SuffixIndex suffixes(config.indexPath);
+            std::vector<std::vector<uint32_t>> wideQueries(queries.size());
+            for (size_t i = 0; i < queries.size(); ++i) {
+                wideQueries[i].assign(queries[i].begin(), queries[i].end());
+            }
+            seconds = medianSeconds(config, [&]() {
+                uint64_t found = 0, sink = 0;
+                for (auto const& query : wideQueries) {
+                    LineCursor cursor(suffixes.wordsTillLine());
+                    for (auto start : suffixes.find(query)) {
+                        sink += cursor.locate(start).word;
+                        ++found;
+                    }
+                }
+                benchSink = sink;
+                return found;
+            }, matches);
+            report("suffix-index", "", "index", text.size(), matches, seconds, first);
+        }
+        std::remove(config.indexPath.c_str());
+    }
+}
+
+// Modes of lab4's exec: `all` finds and locates every occurrence, `count` only counts them,
+// `parallel` does both over chunks, `stream` feeds the text line by line through LineMatcher.
+template <class T>
+void benchText(std::vector<T> const& pattern, std::vector<T> const& text, LineIndex const& lines,
+               BenchConfig const& config, bool& first) {
+    auto end = text.data() + text.size();
+    for (size_t e = 0; e < std::size(ENGINE_NAMES); ++e) {
+        auto name = ENGINE_NAMES[e];
+        if (!selected(config.engine, name)) {
+            continue;
+        }
+        std::optional<SearchEngine<T>> engine;
+        try {
+            engine.emplace(static_cast<Engine>(e), pattern, text);
+        } catch (std::invalid_argument const&) {
+            // Shift-Or and the DFA refuse patterns they can't hold.
+            continue;
+        }
+        std::string_view chosen = static_cast<Engine>(e) == Engine::AUTO ? engineName(engine->engine()) : "";
+        uint64_t matches = 0;
+        if (selected(config.mode, "all")) {
+            auto seconds = medianSeconds(config, [&]() {
+                uint64_t found = 0, sink = 0;
+                LineIndex::Cursor cursor(lines);
+                engine->search(text.data(), end, end, [&](size_t offset) {
+                    sink += cursor.locate(offset).word;
+                    ++found;
+                });
+                benchSink = sink;
+                return found;
+            }, matches);
+            report(name, chosen, "all", text.size(), matches, seconds, first);
+        }
+        if (selected(config.mode, "count")) {
+            auto seconds = medianSeconds(config, [&]() {
+                uint64_t found = 0;
+                engine->search(text.data(), end, end, [&found](size_t) {
+                    ++found;
+                });
+                return found;
+            }, matches);
+            report(name, chosen, "count", text.size(), matches, seconds, first);
+        }
+        if (selected(config.mode, "parallel")) {
+            auto seconds = medianSeconds(config, [&]() {
+                auto occurrences = parallelSearch(*engine, text, config.threads);
+                return static_cast<uint64_t>(parallelLocate(occurrences, lines, config.threads).size());
+            }, matches);
+            report(name, chosen, "parallel", text.size(), matches, seconds, first);
+        }
+    }
+    if (selected(config.engine, "kmp") && selected(config.mode, "stream")) {
+        uint64_t matches = 0;
+        size_t scanned = 0;
+        auto seconds = medianSeconds(config, [&]() {
+            return streamSearch(pattern, text, lines, UINT64_MAX, scanned);
+        }, matches);
+        report("kmp", "", "stream", text.size(), matches, seconds, first);
+    }
+    benchOtherModes(pattern, text, lines, config, first);
+}
+
+void runWorkload(GeneratorConfig const& w, BenchConfig const& config, bool last) {
+    TextGenerator generator(w);
+    AdaptiveText text(generator.getPattern());
+    LineIndex lines;
+    size_t lineStart = 0;
+    generator.generate([&text](uint32_t token) {
+        text.push_back(token);
+    }, [&]() {
+        lines.addLine(text.size() - lineStart);
+        lineStart = text.size();
+    });
+
+    constexpr char const* shapes[] = {"random", "periodic", "worst"};
+    std::cout << "  {\"seed\": " << w.seed << ", \"tokens\": " << w.tokens << ", \"alphabet\": " << w.alphabet
+              << ", \"pattern\": " << w.patternSize << ", \"shape\": \"" << shapes[static_cast<size_t>(w.shape)]
+              << "\", \"period\": " << w.period << ", \"rate\": " << w.rate
+              << ", \"line\": [" << w.minLine << ", " << w.maxLine << "], \"threads\": " << config.threads
+              << ", \"results\": [\n";
+    bool first = true;
+    text.visit([&](auto const& pattern, auto const& narrowText) {
+        benchText(pattern, narrowText, lines, config, first);
+    });
+    std::cout << "\n  ]}" << (last ? "\n" : ",\n");
+}
+
+bool parseArg(std::string_view arg, std::string_view name, uint64_t& value) {
+    if (!arg.starts_with(name)) {
+        return false;
+    }
+    value = std::strtoull(arg.data() + name.size(), nullptr, 10);
+    return true;
+}
+
+// Usage: bench [generator options, see gen] [--warmup=N] [--repeat=N] [--threads=N]
+//              [--engine=all|auto|kmp|...|shift-add|aho-corasick|suffix-index]
+//              [--mode=all|count|parallel|stream|first|exists|mismatches|patterns|build-index|index]
+//              [--first=N] [--mismatches=K] [--pattern-set=N] [--index-file=PATH]
+// Any generator option but the seed and size replaces the default matrix with that single
+// workload. Prints tokens/s and matches/s per engine and mode as JSON.
+int main(int argc, char* argv[]) {
+    try {
+        GeneratorConfig w;
+        w.tokens = 10000000;
+        BenchConfig config;
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg(argv[i]);
+            uint64_t v = 0;
+            if (parseArg(arg, "--warmup=", v)) {
+                config.warmup = v;
+            } else if (parseArg(arg, "--repeat=", v)) {
+                config.repetitions = std::max<uint64_t>(v, 1);
+            } else if (parseArg(arg, "--threads=", v)) {
+                config.threads = std::max<uint64_t>(v, 1);
+            } else if (parseArg(arg, "--first=", v)) {
+                config.first = std::max<uint64_t>(v, 1);
+            } else if (parseArg(arg, "--mismatches=", v)) {
+                config.mismatches = v;
+            } else if (parseArg(arg, "--pattern-set=", v)) {
+                config.patternSet = std::max<uint64_t>(v, 1);
+            } else if (arg.starts_with("--index-file=")) {
+                config.indexPath = arg.substr(13);
+            } else if (arg.starts_with("--engine=")) {
+                config.engine = arg.substr(9);
+            } else if (arg.starts_with("--mode=")) {
+                config.mode = arg.substr(7);
+            } else if (parseGeneratorOption(arg, w)) {
+                config.matrix = config.matrix && (arg.starts_with("--seed=") || arg.starts_with("--tokens="));
+            } else {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                return 1;
+            }
+        }
+
+        std::vector<GeneratorConfig> workloads;
+        if (!config.matrix) {
+            workloads.push_back(w);
+        } else {
+            // Wide and narrow alphabets, a pattern too long for Shift-Or, and the periodic and
+            // `0 ... 0 1` patterns that are hard for skipping engines.
+            struct Shape {
+                uint32_t alphabet;
+                size_t pattern;
+                PatternShape shape;
+            };
+            constexpr Shape shapes[] = {
+                {100000, 16, PatternShape::RANDOM},
+                {4, 16, PatternShape::RANDOM},
+                {4, 100, PatternShape::RANDOM},
+                {4, 64, PatternShape::PERIODIC},
+                {1, 32, PatternShape::WORST},
+            };
+            for (auto const& shape : shapes) {
+                GeneratorConfig next = w;
+                next.alphabet = shape.alphabet;
+                next.patternSize = shape.pattern;
+                next.shape = shape.shape;
+                workloads.push_back(next);
+            }
+        }
+
+        std::cout << "[\n";
+        for (size_t i = 0; i < workloads.size(); ++i) {
+            runWorkload(workloads[i], config, i + 1 == workloads.size());
+        }
+        std::cout << "]\n";
+    } catch (std::exception const& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <buffered_writer.hpp>
+#include <text_generator.hpp>
+
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <string_view>
+
+using namespace da_lab4;
+
+// Usage: gen [--seed=N] [--tokens=N] [--alphabet=N] [--pattern=N] [--shape=random|periodic|worst]
+//            [--period=N] [--rate=X] [--line=MIN/MAX] > test
+// Writes a lab4 input: the pattern on the first line, then the text. Nothing is held in memory,
+// so 10^9 tokens are fine.
+int main(int argc, char* argv[]) {
+    try {
+        GeneratorConfig config;
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg(argv[i]);
+            if (!parseGeneratorOption(arg, config)) {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                return 1;
+            }
+        }
+        TextGenerator generator(config);
+        BufferedWriter writer(stdout);
+        auto const& pattern = generator.getPattern();
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            writer << (i == 0 ? "" : " ") << uint64_t{pattern[i]};
+        }
+        writer << '\n';
+        bool lineStart = true;
+        generator.generate([&](uint32_t token) {
+            if (!lineStart) {
+                writer << ' ';
+            }
+            writer << uint64_t{token};
+            lineStart = false;
+        }, [&]() {
+            writer << '\n';
+            lineStart = true;
+        });
+    } catch (std::exception const& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
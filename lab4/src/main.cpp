@@ -2,120 +2,396 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
-#include <sstream>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <vector>
-#include <tuple>
 
 #include <kmp.hpp>
+#include <adaptive_text.hpp>
+#include <aho_corasick.hpp>
+#include <buffered_writer.hpp>
+#include <line_cursor.hpp>
+#include <line_index.hpp>
+#include <parallel_search.hpp>
+#include <search_engine.hpp>
+#include <shift_add.hpp>
+#include <streaming_matcher.hpp>
+#include <suffix_index.hpp>
+#include <token_reader.hpp>
 
 using intType = uint32_t;
 
-template <class T>
-std::ostream& operator<<(std::ostream& os, std::vector<T> const& v) {
-    for (auto const& e : v) {
-        os << e << ' ';
-    }
-    os << std::endl;
-    return os;
+void readPattern(da_lab4::TokenReader& reader, std::vector<intType>& pattern) {
+    reader.readLine(pattern);
 }
 
-using UnableToKeepReadingException = std::runtime_error;
+template <class Text>
+void readText(da_lab4::TokenReader& reader, Text& text, da_lab4::LineIndex& lines) {
+    size_t before = text.size();
+    auto append = [&text](uint64_t value) {
+        text.push_back(static_cast<intType>(value));
+    };
+    while (reader.readLine(append)) {
+        lines.addLine(text.size() - before);
+        before = text.size();
+    }
+}
 
-std::istringstream readLineInISS() {
-    std::string line;
-    std::getline(std::cin, line);
-    if (!std::cin) {
-        throw UnableToKeepReadingException("Error: can't read next line");
+template <class Occurences>
+void writeOccurences(da_lab4::BufferedWriter& writer, Occurences const& occurences, da_lab4::LineIndex const& lines) {
+    da_lab4::LineIndex::Cursor cursor(lines);
+    for (auto const& occurence : occurences) {
+        writer << cursor.locate(occurence);
     }
-    return std::istringstream(line);
 }
 
-std::vector<intType> readWordsInISS(std::istringstream& iss) {
-    std::vector<intType> wordsInLine;
-    intType next;
-    while (iss >> next) {
-        wordsInLine.push_back(next);
+// Parses the text block by block and feeds it through a LineMatcher in spans of up to
+// FEED_TOKENS; nothing but the pattern and its last positions is kept in memory. Tokens of an
+// unfinished line are fed before the reader waits for more input, so matches never wait for the
+// rest of their line. `onMatch(TextPosition)` returns whether to go on; once it says no the
+// reader is stopped, in the middle of a line if need be, so nothing past the answer is read. `onLine()` runs after each line, `onWait()` before each refill.
+template <class OnMatch, class OnLine, class OnWait>
+void streamMatches(da_lab4::TokenReader& reader, std::vector<intType> pattern, OnMatch&& onMatch, OnLine&& onLine,
+                   OnWait&& onWait) {
+    constexpr size_t FEED_TOKENS = 4096;
+    da_lab4::LineMatcher<intType> matcher(std::move(pattern));
+    std::vector<intType> pending;
+    pending.reserve(FEED_TOKENS);
+    bool more = true;
+    auto feedPending = [&]() {
+        for (auto const& start : matcher.feed(pending)) {
+            if (more && !onMatch(start)) {
+                more = false;
+                reader.stop();
+            }
+        }
+        pending.clear();
+    };
+    auto feed = [&](uint64_t value) {
+        pending.push_back(static_cast<intType>(value));
+        if (pending.size() == FEED_TOKENS) {
+            feedPending();
+        }
+    };
+    reader.setBeforeRefill([&]() {
+        feedPending();
+        onWait();
+    });
+    while (reader.readLine(feed)) {
+        feedPending();
+        matcher.endLine();
+        onLine();
     }
-    return wordsInLine;
+    reader.setBeforeRefill(nullptr);
 }
 
-std::vector<intType> readWordsInLine() {
-    auto iss = readLineInISS();
-    return readWordsInISS(iss);
+// Reports every match as soon as its last token is read. With `follow` the matches of a line
+// leave the process once the line is read; otherwise they are flushed whenever the input runs
+// dry, which costs fewer writes on a busy stream and still never holds answers back while the
+// process waits.
+void runStreaming(da_lab4::TokenReader& reader, std::vector<intType> pattern, bool follow) {
+    da_lab4::BufferedWriter writer(stdout);
+    bool matched = false;
+    streamMatches(reader, std::move(pattern), [&](da_lab4::TextPosition start) {
+        writer << start;
+        matched = true;
+        return true;
+    }, [&]() {
+        if (follow && matched) {
+            writer.flush();
+            matched = false;
+        }
+    }, [&]() {
+        writer.flush();
+    });
 }
 
-void readPattern(std::vector<intType>& pattern) {
-    try {
-        pattern = readWordsInLine();
-    } catch (UnableToKeepReadingException const& e) {
-        return;
+// Prints the first `limit` matches, or with `exists` only whether there is one, without reading
+// the input past the last match needed.
+void runFirst(da_lab4::TokenReader& reader, std::vector<intType> pattern, size_t limit, bool exists) {
+    da_lab4::BufferedWriter writer(stdout);
+    size_t found = 0;
+    if (limit != 0) {
+        streamMatches(reader, std::move(pattern), [&](da_lab4::TextPosition start) {
+            if (!exists) {
+                writer << start;
+            }
+            return ++found < limit;
+        }, []() {}, []() {});
+    }
+    if (exists) {
+        writer << std::string_view(found != 0 ? "yes\n" : "no\n");
+    }
+}
+
+// Every occurrence of every pattern in `patternsPath`, one pattern per line; ids are the
+// 1-based line numbers in that file. Output is ordered by position, then by id.
+void runMultiPattern(da_lab4::TokenReader& reader, std::string const& patternsPath) {
+    std::FILE* file = std::fopen(patternsPath.c_str(), "r");
+    if (file == nullptr) {
+        throw std::runtime_error("Error: can't open pattern file " + patternsPath);
+    }
+    std::vector<std::vector<intType>> patterns;
+    {
+        da_lab4::TokenReader patternReader(file);
+        do {
+            patterns.emplace_back();
+        } while (patternReader.readLine(patterns.back()));
+        patterns.pop_back();
+    }
+    std::fclose(file);
+
+    std::vector<intType> text;
+    da_lab4::LineIndex lines;
+
+    readText(reader, text, lines);
+
+    da_lab4::AhoCorasick<intType> automaton(patterns);
+    std::vector<std::pair<size_t, size_t>> occurences;
+    automaton.search(text, [&occurences](size_t id, size_t start) {
+        occurences.emplace_back(start, id);
+    });
+    std::sort(occurences.begin(), occurences.end());
+
+    da_lab4::BufferedWriter writer(stdout);
+    da_lab4::LineIndex::Cursor cursor(lines);
+    for (auto const& [start, id] : occurences) {
+        writer << uint64_t{id + 1} << std::string_view(", ") << cursor.locate(start);
     }
 }
 
-void readText(std::vector<intType>& text, std::vector<intType>& wordsInLines) {
-    while (true) {
-        try {
-            auto wordsInNewline = readWordsInLine();
-            wordsInLines.push_back(
-                static_cast<intType>(wordsInNewline.size())
-            );
-            text.insert(
-                text.end(), 
-                wordsInNewline.begin(), 
-                wordsInNewline.end()
-            );
-        } catch (UnableToKeepReadingException const& e) {
-            break;
+// Builds the index of the text on stdin (no pattern line) into `path`.
+void runBuildIndex(da_lab4::TokenReader& reader, std::string const& path) {
+    std::vector<intType> text;
+    da_lab4::LineIndex lines;
+
+    readText(reader, text, lines);
+
+    da_lab4::SuffixIndex::build(text, lines.prefixSums(), path);
+}
+
+// Answers every line of stdin as a pattern against the index, as `query_id, line, word` with
+// 1-based query ids; the answer to each query is flushed before the next one is read.
+void runIndexQueries(da_lab4::TokenReader& reader, std::string const& path) {
+    da_lab4::SuffixIndex index(path);
+    da_lab4::BufferedWriter writer(stdout);
+    std::vector<intType> pattern;
+    for (uint64_t id = 1; reader.readLine(pattern); ++id) {
+        da_lab4::LineCursor cursor(index.wordsTillLine());
+        for (auto start : index.find(pattern)) {
+            writer << id << std::string_view(", ") << cursor.locate(start);
         }
+        writer.flush();
+        pattern.clear();
     }
 }
 
-std::vector<intType> summarize(std::vector<intType> const& v) {
-    std::vector<intType> summarized = {0};
-    summarized.insert(summarized.end(), v.begin(), v.end());
-    for (size_t i = 1; i < summarized.size(); ++i) {
-        summarized[i] += summarized[i - 1];
+enum class Query {
+    ALL,
+    COUNT,
+    FIRST,
+    EXISTS
+};
+
+struct Options {
+    bool stream = false;
+    bool follow = false;
+    Query query = Query::ALL;
+    size_t first = 0;
+    std::string patternsPath;
+    std::string buildIndexPath;
+    std::string indexPath;
+    size_t threads = 1;
+    // Occurrences with up to `mismatches` substituted tokens.
+    bool approximate = false;
+    size_t mismatches = 0;
+    da_lab4::Engine engine = da_lab4::Engine::AUTO;
+    // The original KnuthMorrisPrattAlgorithm library, kept to cross-check the engines.
+    bool reference = false;
+};
+
+bool parseNumber(std::string_view arg, std::string_view prefix, size_t& value) {
+    if (!arg.starts_with(prefix)) {
+        return false;
     }
-    return summarized;
+    value = std::strtoull(arg.data() + prefix.size(), nullptr, 10);
+    return true;
 }
 
-std::tuple<size_t, size_t> getLineAndWordFromOccurence(size_t occurence, std::vector<intType> const& wordsTillLine) {
-    size_t line, word;
-    auto lineIt = std::upper_bound(wordsTillLine.begin(), wordsTillLine.end(), occurence);
-    lineIt--;
+Options parseOptions(int argc, char* argv[]) {
+    constexpr std::string_view patternsPrefix = "--patterns=";
+    constexpr std::string_view enginePrefix = "--engine=";
+    constexpr std::string_view buildIndexPrefix = "--build-index=";
+    constexpr std::string_view indexPrefix = "--index=";
+    Options options;
+    size_t number = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        if (parseNumber(arg, "--threads=", number)) {
+            options.threads = std::max<size_t>(number, 1);
+        } else if (arg == "--stream") {
+            options.stream = true;
+        } else if (arg == "--follow") {
+            options.stream = true;
+            options.follow = true;
+        } else if (arg == "--count") {
+            options.query = Query::COUNT;
+        } else if (arg == "--exists") {
+            options.query = Query::EXISTS;
+            options.first = 1;
+        } else if (parseNumber(arg, "--first=", number)) {
+            options.query = Query::FIRST;
+            options.first = number;
+        } else if (parseNumber(arg, "--mismatches=", number)) {
+            options.approximate = true;
+            options.mismatches = number;
+        } else if (arg.starts_with(patternsPrefix)) {
+            options.patternsPath = arg.substr(patternsPrefix.size());
+        } else if (arg == "--engine=reference") {
+            options.reference = true;
+        } else if (arg.starts_with(enginePrefix)) {
+            options.engine = da_lab4::parseEngine(arg.substr(enginePrefix.size()));
+        } else if (arg.starts_with(buildIndexPrefix)) {
+            options.buildIndexPath = arg.substr(buildIndexPrefix.size());
+        } else if (arg.starts_with(indexPrefix)) {
+            options.indexPath = arg.substr(indexPrefix.size());
+        }
+    }
+    return options;
+}
 
-    line = static_cast<size_t>(std::distance(
-        wordsTillLine.cbegin(),
-        lineIt
-    ));
-    word = occurence - static_cast<size_t>(wordsTillLine[line]);
+// Single-pattern search over tokens of any width, as picked by AdaptiveText.
+template <class T>
+void searchText(Options const& options, std::vector<T> const& pattern, std::vector<T> const& text,
+                da_lab4::LineIndex const& lines) {
+    da_lab4::BufferedWriter writer(stdout);
+    da_lab4::SearchEngine<T> engine(options.engine, pattern, text);
+    auto end = text.data() + text.size();
 
-    return std::make_tuple(line + 1, word + 1);
+    // Counting needs neither the occurrences nor their positions.
+    if (options.query == Query::COUNT) {
+        uint64_t count = 0;
+        if (1 < options.threads) {
+            count = da_lab4::parallelCount(engine, text, options.threads);
+        } else {
+            engine.search(text.data(), end, end, [&count](size_t) {
+                ++count;
+            });
+        }
+        writer << count << '\n';
+        return;
+    }
+
+    if (1 < options.threads) {
+        auto occurences = da_lab4::parallelSearch(engine, text, options.threads);
+        for (auto const& position : da_lab4::parallelLocate(occurences, lines, options.threads)) {
+            writer << position;
+        }
+        return;
+    }
+
+    std::vector<size_t> occurences;
+    engine.search(text.data(), end, end, [&occurences](size_t offset) {
+        occurences.push_back(offset);
+    });
+    writeOccurences(writer, occurences, lines);
 }
 
-int main() {   
-    std::vector<intType> pattern;
+// Occurrences with at most `options.mismatches` substituted tokens, printed as
+// `line, word, mismatches`; with --count only their number.
+template <class T>
+void searchApproximate(Options const& options, std::vector<T> const& pattern, std::vector<T> const& text,
+                       da_lab4::LineIndex const& lines) {
+    da_lab4::BufferedWriter writer(stdout);
+    da_lab4::ShiftAddMatcher<T> matcher(pattern, options.mismatches);
+    auto end = text.data() + text.size();
+    if (options.query == Query::COUNT) {
+        uint64_t count = 0;
+        matcher.search(text.data(), end, end, [&count](size_t, size_t) {
+            ++count;
+        });
+        writer << count << '\n';
+        return;
+    }
+    da_lab4::LineIndex::Cursor cursor(lines);
+    matcher.search(text.data(), end, end, [&](size_t offset, size_t mismatches) {
+        auto position = cursor.locate(offset);
+        writer << uint64_t{position.line} << std::string_view(", ") << uint64_t{position.word}
+               << std::string_view(", ") << uint64_t{mismatches} << '\n';
+    });
+}
 
-    readPattern(pattern);
+void run(Options const& options, da_lab4::TokenReader& reader) {
+    if (!options.buildIndexPath.empty()) {
+        runBuildIndex(reader, options.buildIndexPath);
+        return;
+    }
+    if (!options.indexPath.empty()) {
+        runIndexQueries(reader, options.indexPath);
+        return;
+    }
+    if (!options.patternsPath.empty()) {
+        runMultiPattern(reader, options.patternsPath);
+        return;
+    }
 
-    std::vector<intType> text;
-    std::vector<intType> wordsInLines;
+    std::vector<intType> pattern;
 
-    readText(text, wordsInLines);
+    readPattern(reader, pattern);
 
-    auto wordsTillLine = summarize(wordsInLines);
+    da_lab4::LineIndex lines;
 
-    cust::KnuthMorrisPrattAlgorithm<intType> kmp(pattern, text);
+    if (options.approximate) {
+        da_lab4::AdaptiveText text(pattern);
+        readText(reader, text, lines);
+        text.visit([&](auto const& narrowPattern, auto const& narrowText) {
+            searchApproximate(options, narrowPattern, narrowText, lines);
+        });
+        return;
+    }
+    if (options.query == Query::FIRST || options.query == Query::EXISTS) {
+        runFirst(reader, std::move(pattern), options.first, options.query == Query::EXISTS);
+        return;
+    }
+    if (options.stream) {
+        runStreaming(reader, std::move(pattern), options.follow);
+        return;
+    }
+    if (options.reference) {
+        std::vector<intType> text;
+        readText(reader, text, lines);
+        da_lab4::BufferedWriter writer(stdout);
+        cust::KnuthMorrisPrattAlgorithm<intType> kmp(pattern, text);
+        auto occurences = kmp.findAllOccurences();
+        if (options.query == Query::COUNT) {
+            writer << uint64_t{occurences.size()} << '\n';
+            return;
+        }
+        writeOccurences(writer, occurences, lines);
+        return;
+    }
 
-    auto occurences = kmp.findAllOccurences();
+    da_lab4::AdaptiveText text(pattern);
+    readText(reader, text, lines);
+    text.visit([&](auto const& narrowPattern, auto const& narrowText) {
+        searchText(options, narrowPattern, narrowText, lines);
+    });
+}
 
-    size_t line, word;
-    for (auto const& occurence : occurences) {
-        // line = 1, word = occurence + 1;
-        std::tie(line, word) = getLineAndWordFromOccurence(occurence, wordsTillLine);
-        std::cout << line << ", " << word << std::endl;
+int main(int argc, char* argv[]) {
+    try {
+        auto options = parseOptions(argc, argv);
+        da_lab4::TokenReader reader(stdin);
+        run(options, reader);
+    } catch (std::exception const& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
     }
 
     return 0;
-}
\ No newline at end of file
+}
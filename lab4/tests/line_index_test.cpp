@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <line_index.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace da_lab4;
+
+// Exposes select so the bit positions can be checked against the lines they were built from.
+class LineIndexTest : public LineIndex {
+public:
+    size_t _select(bool bit, size_t k) const {
+        return select(bit, k);
+    }
+};
+
+// Builds the index and the plain prefix sums of the same line lengths.
+LineIndexTest buildIndex(std::vector<size_t> const& lengths, std::vector<uint32_t>& sums) {
+    LineIndexTest index;
+    sums = {0};
+    for (size_t length : lengths) {
+        index.addLine(length);
+        sums.push_back(static_cast<uint32_t>(sums.back() + length));
+    }
+    return index;
+}
+
+// Checks every query against the prefix sums: locate and lineStart for each line and token,
+// select for every bit, and cursors started at a few offsets with several strides.
+void checkIndex(std::vector<size_t> const& lengths, std::mt19937& rng) {
+    std::vector<uint32_t> sums;
+    auto index = buildIndex(lengths, sums);
+    ASSERT_EQ(index.lines(), lengths.size());
+    ASSERT_EQ(index.tokens(), sums.back());
+    ASSERT_EQ(index.prefixSums(), sums);
+
+    for (size_t line = 0; line < lengths.size(); ++line) {
+        ASSERT_EQ(index.lineStart(line), sums[line]) << "line " << line;
+        // The 1 ending a line follows its tokens and the ends of the lines before it.
+        ASSERT_EQ(index._select(true, line), sums[line + 1] + line) << "line " << line;
+        for (size_t offset = sums[line]; offset < sums[line + 1]; ++offset) {
+            ASSERT_EQ(index._select(false, offset), offset + line) << "offset " << offset;
+            auto position = index.locate(offset);
+            ASSERT_EQ(position.line, line + 1) << "offset " << offset;
+            ASSERT_EQ(position.word, offset - sums[line] + 1) << "offset " << offset;
+        }
+    }
+
+    size_t tokens = sums.back();
+    if (tokens == 0) {
+        return;
+    }
+    for (size_t stride : std::vector<size_t>{1, 3, 511, 513, 5000}) {
+        size_t offset = stride == 1 ? 0 : rng() % tokens;
+        LineIndex::Cursor cursor(index, offset);
+        for (; offset < tokens; offset += 1 + rng() % stride) {
+            auto expected = index.locate(offset);
+            auto position = cursor.locate(offset);
+            ASSERT_EQ(position.line, expected.line) << "stride " << stride << ", offset " << offset;
+            ASSERT_EQ(position.word, expected.word) << "stride " << stride << ", offset " << offset;
+        }
+    }
+}
+
+TEST(LineIndexTests, emptyIndex) {
+    LineIndex index;
+    EXPECT_EQ(index.lines(), 0u);
+    EXPECT_EQ(index.tokens(), 0u);
+    EXPECT_EQ(index.prefixSums(), std::vector<uint32_t>({0}));
+}
+
+TEST(LineIndexTests, emptyLines) {
+    std::mt19937 rng(1);
+    // Only 1 bits, enough of them for several one samples.
+    checkIndex(std::vector<size_t>(3 * LineIndex::SAMPLE + 5, 0), rng);
+    checkIndex({0, 0, 1, 0, 0, 0, 2, 0}, rng);
+    checkIndex({5}, rng);
+}
+
+TEST(LineIndexTests, linesAroundSuperblocks) {
+    std::mt19937 rng(2);
+    size_t const block = LineIndex::SUPERBLOCK;
+    for (size_t length : std::vector<size_t>{block - 2, block - 1, block, block + 1, 2 * block - 1}) {
+        checkIndex(std::vector<size_t>(20, length), rng);
+        // A line end lands on every bit position of a superblock in turn.
+        std::vector<size_t> shifted;
+        for (size_t i = 0; i < 40; ++i) {
+            shifted.push_back(length + i % 3);
+            shifted.push_back(0);
+        }
+        checkIndex(shifted, rng);
+    }
+}
+
+TEST(LineIndexTests, linesAroundSamples) {
+    std::mt19937 rng(3);
+    size_t const sample = LineIndex::SAMPLE;
+    for (size_t length : std::vector<size_t>{sample - 1, sample, sample + 1, 3 * sample + 7}) {
+        checkIndex({length, 0, length, 1, 0, length}, rng);
+    }
+    // One line holding many zero samples between two empty ones.
+    checkIndex({0, 10 * sample + 3, 0}, rng);
+}
+
+TEST(LineIndexTests, randomLines) {
+    std::mt19937 rng(4);
+    for (int round = 0; round < 60; ++round) {
+        size_t maxLength = round % 3 == 0 ? 3 : round % 3 == 1 ? 40 : 6000;
+        std::vector<size_t> lengths(rng() % (maxLength < 100 ? 2000 : 100));
+        for (auto& length : lengths) {
+            length = rng() % 4 == 0 ? 0 : rng() % (maxLength + 1);
+        }
+        checkIndex(lengths, rng);
+    }
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
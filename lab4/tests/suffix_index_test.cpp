@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <suffix_array.hpp>
+#include <suffix_index.hpp>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace da_lab4;
+
+template <class T>
+std::vector<int32_t> naiveSuffixArray(std::vector<T> const& s) {
+    std::vector<int32_t> sa(s.size());
+    std::iota(sa.begin(), sa.end(), 0);
+    std::sort(sa.begin(), sa.end(), [&s](int32_t a, int32_t b) {
+        return std::lexicographical_compare(s.begin() + a, s.end(), s.begin() + b, s.end());
+    });
+    return sa;
+}
+
+std::vector<int32_t> randomRanks(std::mt19937& rng, size_t size, int32_t upper) {
+    std::vector<int32_t> s(size);
+    for (auto& c : s) {
+        c = static_cast<int32_t>(rng() % static_cast<uint32_t>(upper + 1));
+    }
+    return s;
+}
+
+// Index file in the temporary directory, removed with the object.
+class TempIndex {
+public:
+    explicit TempIndex(std::string const& name)
+        : path((std::filesystem::temp_directory_path()
+                / ("da_lab4_" + std::to_string(::getpid()) + "_" + name + ".idx")).string()) {}
+
+    ~TempIndex() {
+        std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+TEST(SuffixArrayTests, tinyTexts) {
+    EXPECT_TRUE(suffixArrayIs({}, 0).empty());
+    EXPECT_EQ(suffixArrayIs({0}, 0), std::vector<int32_t>({0}));
+    EXPECT_EQ(suffixArrayIs({1, 0}, 1), std::vector<int32_t>({1, 0}));
+    EXPECT_EQ(suffixArrayIs({0, 1}, 1), std::vector<int32_t>({0, 1}));
+    EXPECT_EQ(suffixArrayIs({0, 0}, 0), std::vector<int32_t>({1, 0}));
+}
+
+TEST(SuffixArrayTests, periodicTexts) {
+    for (size_t n : std::vector<size_t>{3, 4, 17, 64, 1000}) {
+        std::vector<int32_t> same(n, 0);
+        EXPECT_EQ(suffixArrayIs(same, 0), naiveSuffixArray(same)) << n;
+
+        std::vector<int32_t> alternating(n);
+        for (size_t i = 0; i < n; ++i) {
+            alternating[i] = static_cast<int32_t>(i % 2);
+        }
+        EXPECT_EQ(suffixArrayIs(alternating, 1), naiveSuffixArray(alternating)) << n;
+
+        std::vector<int32_t> descending(n);
+        for (size_t i = 0; i < n; ++i) {
+            descending[i] = static_cast<int32_t>((n - i) % 5);
+        }
+        EXPECT_EQ(suffixArrayIs(descending, 4), naiveSuffixArray(descending)) << n;
+    }
+}
+
+TEST(SuffixArrayTests, randomTextsMatchNaiveSort) {
+    std::mt19937 rng(42);
+    for (int round = 0; round < 400; ++round) {
+        size_t size = rng() % (round < 300 ? 40 : 3000);
+        // Small alphabets give the long LMS substrings and the deep recursion.
+        int32_t upper = round % 4 == 0 ? 1 : round % 4 == 1 ? 2 : round % 4 == 2 ? 9 : 300;
+        auto s = randomRanks(rng, size, upper);
+        ASSERT_EQ(suffixArrayIs(s, upper), naiveSuffixArray(s)) << "round " << round;
+    }
+}
+
+TEST(SuffixArrayTests, buildRanksSparseTokens) {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 50; ++round) {
+        std::vector<uint32_t> text(rng() % 500);
+        for (auto& token : text) {
+            token = static_cast<uint32_t>(rng() % 4 == 0 ? UINT32_MAX - rng() % 3 : rng() % 6 * 1000003u);
+        }
+        ASSERT_EQ(buildSuffixArray(text), naiveSuffixArray(text)) << "round " << round;
+    }
+}
+
+TEST(SuffixIndexTests, roundTripAndFind) {
+    std::mt19937 rng(5);
+    TempIndex file("round_trip");
+    for (int round = 0; round < 30; ++round) {
+        std::vector<uint32_t> text(rng() % 2000);
+        for (auto& token : text) {
+            token = static_cast<uint32_t>(rng() % (round % 2 == 0 ? 3 : 50));
+        }
+        // Some lines are empty and the last one may end the text.
+        std::vector<uint32_t> wordsTillLine = {0};
+        while (wordsTillLine.back() < text.size()) {
+            auto next = std::min<uint32_t>(wordsTillLine.back() + static_cast<uint32_t>(rng() % 20), static_cast<uint32_t>(text.size()));
+            wordsTillLine.push_back(next);
+        }
+        wordsTillLine.push_back(wordsTillLine.back());
+
+        SuffixIndex::build(text, wordsTillLine, file.path);
+        // Header, tokens and suffixes, prefix sums, each padded to 8 bytes.
+        EXPECT_EQ(std::filesystem::file_size(file.path),
+                  24 + 2 * ((4 * text.size() + 7) / 8 * 8) + (4 * wordsTillLine.size() + 7) / 8 * 8);
+
+        SuffixIndex index(file.path);
+        ASSERT_TRUE(std::equal(index.text().begin(), index.text().end(), text.begin(), text.end()));
+        ASSERT_TRUE(std::equal(index.wordsTillLine().begin(), index.wordsTillLine().end(),
+                               wordsTillLine.begin(), wordsTillLine.end()));
+
+        for (int query = 0; query < 20; ++query) {
+            std::vector<uint32_t> pattern(1 + rng() % 4);
+            if (query % 2 == 0 && pattern.size() <= text.size()) {
+                size_t from = rng() % (text.size() - pattern.size() + 1);
+                std::copy_n(text.begin() + static_cast<std::ptrdiff_t>(from), pattern.size(), pattern.begin());
+            } else {
+                for (auto& token : pattern) {
+                    token = static_cast<uint32_t>(rng() % 4);
+                }
+            }
+            std::vector<size_t> expected;
+            for (size_t i = 0; i + pattern.size() <= text.size(); ++i) {
+                if (std::equal(pattern.begin(), pattern.end(), text.begin() + static_cast<std::ptrdiff_t>(i))) {
+                    expected.push_back(i);
+                }
+            }
+            ASSERT_EQ(index.find(pattern), expected) << "round " << round << ", query " << query;
+        }
+        EXPECT_TRUE(index.find({}).empty());
+    }
+}
+
+TEST(SuffixIndexTests, rejectsForeignFiles) {
+    TempIndex file("foreign");
+    EXPECT_THROW(SuffixIndex("/nonexistent/da_lab4.idx"), std::runtime_error);
+
+    std::ofstream(file.path) << "not an index";
+    EXPECT_THROW(SuffixIndex{file.path}, std::runtime_error);
+
+    SuffixIndex::build({1, 2, 3}, {0, 3}, file.path);
+    EXPECT_NO_THROW(SuffixIndex{file.path});
+    std::filesystem::resize_file(file.path, std::filesystem::file_size(file.path) - 8);
+    EXPECT_THROW(SuffixIndex{file.path}, std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}